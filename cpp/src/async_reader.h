@@ -0,0 +1,417 @@
+#pragma once
+/// Read-ahead input backends for the CSV parser.
+/// Instead of faulting mmap pages in one at a time as the parser first
+/// touches them, the file is read into a ring of DEPTH fixed buffers that
+/// are kept in flight ahead of the parser, so parsing block i overlaps the
+/// reads of blocks i+1 .. i+DEPTH-1.
+///
+/// Two backends share one interface (open / wait / recycle):
+///   UringReadAhead   io_uring via raw syscalls (no liburing): one
+///                    IORING_OP_READ per buffer, reaped in any order.
+///   ThreadReadAhead  a helper thread issuing pread() into the same ring,
+///                    for kernels or sandboxes without io_uring.
+/// AsyncCsvReader drives either one and stitches lines that straddle
+/// buffer boundaries, so its output equals CsvReader::parse_file.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "types.h"
+#include "instrument.h"
+#include "parser.h"
+
+/// DEPTH buffers of BLOCK bytes, page aligned.
+struct ReadRing {
+    static constexpr size_t DEPTH = 8;
+    static constexpr size_t BLOCK = 1 << 20;
+
+    std::unique_ptr<char, decltype(&free)> mem{nullptr, &free};
+    int    fd    = -1;
+    size_t size  = 0;        // file size
+    size_t count = 0;        // number of blocks in the file
+
+    bool init(int file_fd, size_t file_size) {
+        fd = file_fd;
+        size = file_size;
+        count = (size + BLOCK - 1) / BLOCK;
+        mem.reset(static_cast<char*>(aligned_alloc(4096, DEPTH * BLOCK)));
+        return mem != nullptr;
+    }
+
+    char*  buffer(size_t block) const { return mem.get() + (block % DEPTH) * BLOCK; }
+    size_t offset(size_t block) const { return block * BLOCK; }
+    size_t length(size_t block) const { return std::min(BLOCK, size - offset(block)); }
+};
+
+class UringReadAhead {
+public:
+    static constexpr const char* NAME = "io_uring";
+
+    UringReadAhead() = default;
+    ~UringReadAhead() {
+        // The kernel writes into ring_ buffers until each read completes:
+        // an early exit (I/O error, parse stopped) must not free them first.
+        drain();
+        if (sq_ptr_ != MAP_FAILED) munmap(sq_ptr_, sq_bytes_);
+        if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) munmap(cq_ptr_, cq_bytes_);
+        if (sqes_ != MAP_FAILED) munmap(sqes_, sqe_bytes_);
+        if (ring_fd_ >= 0) close(ring_fd_);
+    }
+
+    UringReadAhead(const UringReadAhead&) = delete;
+    UringReadAhead& operator=(const UringReadAhead&) = delete;
+
+    /// True if this process may create an io_uring (not blocked by seccomp,
+    /// an old kernel or io_uring_disabled).
+    static bool available() {
+        io_uring_params p{};
+        const int fd = static_cast<int>(syscall(__NR_io_uring_setup, 1, &p));
+        if (fd < 0) return false;
+        close(fd);
+        return true;
+    }
+
+    /// Set up the ring and queue reads for the first DEPTH blocks. False if
+    /// io_uring is unavailable (the caller falls back to ThreadReadAhead).
+    bool open(int fd, size_t size) {
+        if (!ring_.init(fd, size) || !setup()) return false;
+        for (size_t b = 0; b < std::min(ReadRing::DEPTH, ring_.count); ++b) submit(b);
+        return true;
+    }
+
+    /// Block until `block` (requested in order) is fully read. Empty span on
+    /// I/O error.
+    std::span<const char> wait(size_t block) {
+        Slot& s = slots_[block % ReadRing::DEPTH];
+        while (!s.done && !s.failed) {
+            if (!reap()) return {};
+        }
+        if (s.failed) return {};
+        return {ring_.buffer(block), s.filled};
+    }
+
+    /// The parser is done with `block`; reuse its buffer for block + DEPTH.
+    void recycle(size_t block) {
+        if (block + ReadRing::DEPTH < ring_.count) submit(block + ReadRing::DEPTH);
+    }
+
+    size_t blocks() const { return ring_.count; }
+
+private:
+    struct Slot {
+        size_t block  = 0;
+        size_t filled = 0;
+        bool   done   = false;
+        bool   failed = false;
+    };
+
+    ReadRing ring_;
+    Slot     slots_[ReadRing::DEPTH];
+    int      ring_fd_   = -1;
+    void*    sq_ptr_    = MAP_FAILED;
+    void*    cq_ptr_    = MAP_FAILED;
+    void*    sqes_      = MAP_FAILED;
+    size_t   sq_bytes_  = 0;
+    size_t   cq_bytes_  = 0;
+    size_t   sqe_bytes_ = 0;
+    unsigned *sq_tail_ = nullptr, *sq_mask_ = nullptr, *sq_array_ = nullptr;
+    unsigned *cq_head_ = nullptr, *cq_tail_ = nullptr, *cq_mask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    size_t   in_flight_ = 0;   // reads submitted and not yet completed
+
+    bool setup() {
+        io_uring_params p{};
+        ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, ReadRing::DEPTH, &p));
+        if (ring_fd_ < 0) return false;
+
+        sq_bytes_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_bytes_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) sq_bytes_ = cq_bytes_ = std::max(sq_bytes_, cq_bytes_);
+
+        sq_ptr_ = mmap(nullptr, sq_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd_, IORING_OFF_SQ_RING);
+        if (sq_ptr_ == MAP_FAILED) return false;
+        cq_ptr_ = single ? sq_ptr_
+                         : mmap(nullptr, cq_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ptr_ == MAP_FAILED) return false;
+        sqe_bytes_ = p.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = mmap(nullptr, sqe_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ring_fd_, IORING_OFF_SQES);
+        if (sqes_ == MAP_FAILED) return false;
+
+        auto* sq = static_cast<char*>(sq_ptr_);
+        auto* cq = static_cast<char*>(cq_ptr_);
+        sq_tail_  = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_mask_  = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        cq_head_  = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_tail_  = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask_  = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes_     = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        return true;
+    }
+
+    void submit(size_t block) {
+        Slot& s = slots_[block % ReadRing::DEPTH];
+        s = Slot{block, 0, false, false};
+        queue_read(block, 0);
+    }
+
+    /// Queue a read of the rest of `block` from byte `from` and enter it.
+    /// Without SQPOLL the kernel only consumes SQEs inside io_uring_enter,
+    /// and a failed enter consumes none, so on failure the tail is rolled
+    /// back: no stale SQE is left for a later enter to submit uncounted.
+    void queue_read(size_t block, size_t from) {
+        const unsigned tail = __atomic_load_n(sq_tail_, __ATOMIC_RELAXED);
+        const unsigned idx = tail & *sq_mask_;
+        io_uring_sqe& sqe = static_cast<io_uring_sqe*>(sqes_)[idx];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode    = IORING_OP_READ;
+        sqe.fd        = ring_.fd;
+        sqe.addr      = reinterpret_cast<uint64_t>(ring_.buffer(block) + from);
+        sqe.len       = static_cast<uint32_t>(ring_.length(block) - from);
+        sqe.off       = ring_.offset(block) + from;
+        sqe.user_data = block;
+        sq_array_[idx] = idx;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+        long submitted;
+        do {
+            submitted = syscall(__NR_io_uring_enter, ring_fd_, 1, 0, 0, nullptr, 0);
+        } while (submitted < 0 && errno == EINTR);
+        if (submitted == 1) {
+            ++in_flight_;
+        } else {
+            __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+            slots_[block % ReadRing::DEPTH].failed = true;
+        }
+    }
+
+    /// Wait for and process at least one completion. False on ring error.
+    bool reap() {
+        unsigned head = __atomic_load_n(cq_head_, __ATOMIC_RELAXED);
+        while (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+            if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 &&
+                errno != EINTR) {
+                return false;
+            }
+        }
+        for (; head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE); ++head) {
+            --in_flight_;
+            const io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+            const size_t block = cqe.user_data;
+            Slot& s = slots_[block % ReadRing::DEPTH];
+            if (cqe.res <= 0) {
+                s.failed = true;
+            } else {
+                s.filled += static_cast<size_t>(cqe.res);
+                if (s.filled < ring_.length(block)) {
+                    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+                    queue_read(block, s.filled); // short read: fetch the rest
+                    continue;
+                }
+                s.done = true;
+            }
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    /// Wait for every submitted read to complete, discarding the results.
+    void drain() {
+        if (cq_head_ == nullptr) return;
+        while (in_flight_ > 0) {
+            unsigned head = __atomic_load_n(cq_head_, __ATOMIC_RELAXED);
+            const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            if (head != tail) {
+                in_flight_ -= std::min<size_t>(in_flight_, tail - head);
+                __atomic_store_n(cq_head_, tail, __ATOMIC_RELEASE);
+                continue;
+            }
+            if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 &&
+                errno != EINTR) {
+                perror("io_uring_enter");
+                return;
+            }
+        }
+    }
+};
+
+class ThreadReadAhead {
+public:
+    static constexpr const char* NAME = "pread thread";
+
+    ThreadReadAhead() = default;
+    ~ThreadReadAhead() {
+        stop_.store(true, std::memory_order_relaxed);
+        consumed_.fetch_add(ReadRing::DEPTH, std::memory_order_release); // unblock the reader
+        consumed_.notify_one();
+        if (reader_.joinable()) reader_.join();
+    }
+
+    ThreadReadAhead(const ThreadReadAhead&) = delete;
+    ThreadReadAhead& operator=(const ThreadReadAhead&) = delete;
+
+    bool open(int fd, size_t size) {
+        if (!ring_.init(fd, size)) return false;
+        reader_ = std::thread([this] { read_loop(); });
+        return true;
+    }
+
+    std::span<const char> wait(size_t block) {
+        size_t ready = produced_.load(std::memory_order_acquire);
+        while (ready <= block) {
+            produced_.wait(ready, std::memory_order_acquire);
+            ready = produced_.load(std::memory_order_acquire);
+        }
+        if (failed_.load(std::memory_order_relaxed) && block + 1 == ready) return {};
+        return {ring_.buffer(block), ring_.length(block)};
+    }
+
+    void recycle(size_t block) {
+        consumed_.store(block + 1, std::memory_order_release);
+        consumed_.notify_one();
+    }
+
+    size_t blocks() const { return ring_.count; }
+
+private:
+    ReadRing            ring_;
+    std::thread         reader_;
+    std::atomic<size_t> produced_{0};   // blocks fully read
+    std::atomic<size_t> consumed_{0};   // blocks released by the parser
+    std::atomic<bool>   stop_{false};
+    std::atomic<bool>   failed_{false};
+
+    void read_loop() {
+        for (size_t b = 0; b < ring_.count; ++b) {
+            // Wait for the buffer this block reuses to be released.
+            size_t released = consumed_.load(std::memory_order_acquire);
+            while (b >= released + ReadRing::DEPTH) {
+                consumed_.wait(released, std::memory_order_acquire);
+                released = consumed_.load(std::memory_order_acquire);
+            }
+            if (stop_.load(std::memory_order_relaxed)) return;
+
+            char* buf = ring_.buffer(b);
+            size_t done = 0, want = ring_.length(b);
+            while (done < want) {
+                ssize_t n = pread(ring_.fd, buf + done, want - done,
+                                  static_cast<off_t>(ring_.offset(b) + done));
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) {
+                    failed_.store(true, std::memory_order_relaxed);
+                    break;
+                }
+                done += static_cast<size_t>(n);
+            }
+            produced_.store(b + 1, std::memory_order_release);
+            produced_.notify_one();
+            if (failed_.load(std::memory_order_relaxed)) return;
+        }
+    }
+};
+
+class AsyncCsvReader {
+public:
+    /// Parse `path` through read-ahead backend `Backend`. Returns false (and
+    /// leaves `out` partial) if the backend cannot start, a read fails, or
+    /// the level arena outgrows UpdateLog::MAX_LEVELS.
+    template <typename Backend>
+    static bool parse_file(const char* path, UpdateLog& out,
+                           const Instrument& inst = Instrument::btc_usdt()) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            perror("open");
+            return false;
+        }
+        struct stat st;
+        fstat(fd, &st);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+        bool ok;
+        {
+            Backend backend;
+            ok = backend.open(fd, static_cast<size_t>(st.st_size)) && drive(backend, inst, out);
+        }
+        close(fd);
+        return ok;
+    }
+
+    /// io_uring when the kernel allows it, else the pread thread.
+    static UpdateLog parse_file(const char* path, const Instrument& inst = Instrument::btc_usdt()) {
+        UpdateLog out;
+        out.reserve(4096);
+        if (!parse_file<UringReadAhead>(path, out, inst)) {
+            out = UpdateLog{};
+            out.reserve(4096);
+            parse_file<ThreadReadAhead>(path, out, inst);
+        }
+        return out;
+    }
+
+private:
+    /// Parse each block's whole lines in place as it arrives. The partial
+    /// line at a block's end is carried over and completed from the next.
+    template <typename Backend>
+    static bool drive(Backend& backend, const Instrument& inst, UpdateLog& out) {
+        std::string carry;
+        bool in_header = true;
+        for (size_t b = 0; b < backend.blocks(); ++b) {
+            auto block = backend.wait(b);
+            if (block.empty()) return false;
+            const char* p = block.data();
+            const char* end = p + block.size();
+
+            if (in_header) {
+                const char* nl = static_cast<const char*>(memchr(p, '\n', end - p));
+                p = nl ? nl + 1 : end;
+                in_header = (nl == nullptr);
+            }
+            if (!carry.empty()) {
+                const char* nl = static_cast<const char*>(memchr(p, '\n', end - p));
+                const char* stop = nl ? nl + 1 : end;
+                carry.append(p, stop);
+                p = stop;
+                if (nl) {
+                    if (!CsvReader::parse_buffer(carry.data(), carry.size(), inst, out)) {
+                        return too_many_levels();
+                    }
+                    carry.clear();
+                }
+            }
+            if (const char* last = static_cast<const char*>(memrchr(p, '\n', end - p))) {
+                if (!CsvReader::parse_buffer(p, static_cast<size_t>(last + 1 - p), inst, out)) {
+                    return too_many_levels();
+                }
+                p = last + 1;
+            }
+            carry.append(p, end);
+            backend.recycle(b);
+        }
+        if (!carry.empty() && !CsvReader::parse_buffer(carry.data(), carry.size(), inst, out)) {
+            return too_many_levels();
+        }
+        return true;
+    }
+
+    static bool too_many_levels() {
+        fprintf(stderr, "parse: more than %zu snapshot levels\n", UpdateLog::MAX_LEVELS);
+        return false;
+    }
+};
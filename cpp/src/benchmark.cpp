@@ -2,16 +2,36 @@
 /// Mirrors the Rust benchmark exactly for fair comparison.
 
 #include <cstdio>
+#include <cstdlib>
+#include <new>
 #include <thread>
+#include <chrono>
 #include <atomic>
 #include <vector>
 #include <algorithm>
 #include <memory>
+#include <random>
+#include <string>
+#include <cstring>
+#include <bit>
 
 #include "types.h"
 #include "orderbook.h"
+#include "price_ladder.h"
+#include "vector_levels.h"
+#include "btree_levels.h"
+#include "pooled_map_levels.h"
+#include "update_columns.h"
+#include "decimal_parser.h"
 #include "parser.h"
+#include "csv_stream.h"
+#include "parallel_parser.h"
+#include "capture.h"
+#include "async_reader.h"
 #include "spsc_queue.h"
+#include "spsc_seq_queue.h"
+#include "spsc_ring.h"
+#include "broadcast_ring.h"
 #include "strategy.h"
 #include "clock.h"
 
@@ -19,14 +39,963 @@ static constexpr size_t QUEUE_CAPACITY = 4096;
 static constexpr int WARMUP_ITERATIONS = 5;
 static constexpr int BENCH_ITERATIONS = 20;
 
+// ── Allocation counting ──
+// Every heap allocation in this binary goes through these replacements, so
+// the benchmark can report how many calls a replay makes.
+static std::atomic<uint64_t> g_alloc_calls{0};
+
+void* operator new(size_t n) {
+    g_alloc_calls.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    std::abort();
+}
+
+void* operator new(size_t n, std::align_val_t al) {
+    g_alloc_calls.fetch_add(1, std::memory_order_relaxed);
+    size_t a = static_cast<size_t>(al);
+    if (void* p = std::aligned_alloc(a, (n + a - 1) / a * a)) return p;
+    std::abort();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
 // Prevent dead code elimination
 template <typename T>
 static void do_not_optimize(const T& val) {
     asm volatile("" : : "r,m"(val) : "memory");
 }
 
+struct EngineTimes {
+    uint64_t avg_ns;
+    uint64_t min_ns;
+};
+
+/// Time the isolated apply() loop of any engine exposing the Orderbook surface.
+template <typename Book>
+static EngineTimes bench_engine(const UpdateLog& feed) {
+    for (int i = 0; i < WARMUP_ITERATIONS; ++i) {
+        Book book;
+        for (const auto& u : feed.updates) book.apply(u, feed.levels, 0);
+    }
+
+    std::vector<uint64_t> times;
+    times.reserve(BENCH_ITERATIONS);
+    for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+        Book book;
+        uint64_t start = Clock::now_ns();
+        for (const auto& u : feed.updates) {
+            book.apply(u, feed.levels, 0);
+        }
+        uint64_t end = Clock::now_ns();
+        times.push_back(end - start);
+        do_not_optimize(book.best_bid());
+    }
+
+    uint64_t avg = 0;
+    for (auto t : times) avg += t;
+    avg /= times.size();
+    return EngineTimes{avg, *std::min_element(times.begin(), times.end())};
+}
+
+/// Replay `feed` into both engines and compare the final books.
+template <typename A, typename B>
+static bool same_final_book(const UpdateLog& feed) {
+    A a;
+    B b;
+    for (const auto& u : feed.updates) {
+        a.apply(u, feed.levels, 0);
+        b.apply(u, feed.levels, 0);
+    }
+    auto eq = [](std::optional<Level> x, std::optional<Level> y) {
+        if (x.has_value() != y.has_value()) return false;
+        return !x || (x->price == y->price && x->qty == y->qty);
+    };
+    return a.bid_depth() == b.bid_depth() && a.ask_depth() == b.ask_depth() &&
+           eq(a.best_bid(), b.best_bid()) && eq(a.best_ask(), b.best_ask());
+}
+
+/// Heap allocations per update once the book is warm: replay everything
+/// once, then count calls made while replaying it again on the same book.
+template <typename Book>
+static double steady_state_allocs(const UpdateLog& feed) {
+    Book book;
+    for (const auto& u : feed.updates) book.apply(u, feed.levels, 0);
+    uint64_t before = g_alloc_calls.load(std::memory_order_relaxed);
+    for (const auto& u : feed.updates) book.apply(u, feed.levels, 0);
+    uint64_t calls = g_alloc_calls.load(std::memory_order_relaxed) - before;
+    do_not_optimize(book.best_bid());
+    return static_cast<double>(calls) / feed.size();
+}
+
+/// One row of the level-store comparison table.
+template <template <Side> class Levels>
+static void report_policy(const char* name, const UpdateLog& feed,
+                          double baseline_tp) {
+    using Book = BasicOrderbook<Levels>;
+    auto times = bench_engine<Book>(feed);
+    double tp = (feed.size() / static_cast<double>(times.min_ns)) * 1e9;
+    printf("  %-10s %9.1f ns %14.0f/s %8.2fx %12.4f %7s\n",
+        name,
+        static_cast<double>(times.min_ns) / feed.size(),
+        tp,
+        tp / baseline_tp,
+        steady_state_allocs<Book>(feed),
+        same_final_book<Orderbook, Book>(feed) ? "yes" : "NO");
+}
+
+/// Run every level-store policy over `feed`, relative to std::map.
+static void compare_policies(const UpdateLog& feed) {
+    auto base = bench_engine<Orderbook>(feed);
+    double base_tp = (feed.size() / static_cast<double>(base.min_ns)) * 1e9;
+
+    printf("  %-10s %12s %16s %9s %12s %7s\n",
+        "policy", "per-update", "throughput", "vs map", "allocs/upd", "match");
+    report_policy<MapLevels>("map", feed, base_tp);
+    report_policy<PooledMapLevels>("pooled-map", feed, base_tp);
+    report_policy<VectorLevels>("vector", feed, base_tp);
+    report_policy<BTreeLevels>("btree", feed, base_tp);
+    report_policy<PriceLadder>("ladder", feed, base_tp);
+}
+
+/// Deep synthetic book: one snapshot of `depth` levels per side, then
+/// `count` incrementals clustered near a random-walking touch (roughly a
+/// third of them deletes), with the occasional update deep in the book.
+static UpdateLog make_synthetic_updates(size_t depth, size_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    UpdateLog out;
+    out.updates.reserve(count + 1);
+    out.levels.reserve(depth * 2);
+
+    uint64_t mid = 10'000'000;
+    auto qty = [&rng]() { return Qty(rng() % 10'000'000'000 + 1); };
+
+    Update snap{};
+    snap.type = Update::Type::Snapshot;
+    snap.timestamp = 0;
+    snap.levels_begin = 0;
+    snap.bid_count = static_cast<uint32_t>(depth);
+    snap.ask_count = static_cast<uint32_t>(depth);
+    uint64_t bid = mid - 1, ask = mid + 1;
+    for (size_t i = 0; i < depth; ++i) {
+        out.levels.push_back(Level{Price(bid), qty()});
+        bid -= 1 + rng() % 3;
+    }
+    for (size_t i = 0; i < depth; ++i) {
+        out.levels.push_back(Level{Price(ask), qty()});
+        ask += 1 + rng() % 3;
+    }
+    out.updates.push_back(snap);
+
+    std::geometric_distribution<uint64_t> near_touch(0.3);
+    for (size_t i = 0; i < count; ++i) {
+        if (rng() % 16 == 0) mid += (rng() & 1) ? 1 : -1;
+
+        Update u{};
+        u.type = Update::Type::Incremental;
+        u.timestamp = i + 1;
+        u.side = (rng() & 1) ? Side::Bid : Side::Ask;
+        uint64_t offset = (rng() % 64 == 0) ? rng() % (depth * 2) : near_touch(rng);
+        u.level.price = Price(u.side == Side::Bid ? mid - 1 - offset : mid + 1 + offset);
+        u.level.qty = (rng() % 3 == 0) ? Qty(0) : qty();
+        out.updates.push_back(u);
+    }
+    return out;
+}
+
+/// Per-field cost of decimal -> fixed-point conversion on price- and
+/// size-shaped fields, byte-at-a-time vs SWAR. Each field is parsed with
+/// the decimals of its kind, as the CSV parser does. Returns false on
+/// mismatch.
+static bool report_decimal_fields() {
+    constexpr size_t FIELDS = 1'000'000;
+    constexpr int RUNS = 5;
+    const Instrument inst = Instrument::btc_usdt();
+    struct Field {
+        uint32_t offset;
+        uint32_t length;
+        uint32_t decimals;
+    };
+    std::mt19937_64 rng(7);
+    std::string text;
+    std::vector<Field> fields;
+    fields.reserve(FIELDS);
+    char buf[32];
+    for (size_t i = 0; i < FIELDS; ++i) {
+        const bool price = i & 1;
+        int n = price
+            ? snprintf(buf, sizeof(buf), "%llu.%02llu",
+                  static_cast<unsigned long long>(90'000 + rng() % 20'000),
+                  static_cast<unsigned long long>(rng() % 100))
+            : snprintf(buf, sizeof(buf), "%llu.%04llu",
+                  static_cast<unsigned long long>(rng() % 10),
+                  static_cast<unsigned long long>(rng() % 10'000));
+        fields.push_back({static_cast<uint32_t>(text.size()), static_cast<uint32_t>(n),
+                          price ? inst.price_decimals : inst.qty_decimals});
+        text.append(buf, n);
+    }
+
+    auto run = [&](auto parse) {
+        uint64_t best = UINT64_MAX, sum = 0;
+        for (int r = 0; r < RUNS; ++r) {
+            sum = 0;
+            uint64_t start = Clock::now_ns();
+            for (const Field& f : fields) {
+                const char* b = text.data() + f.offset;
+                sum += parse(b, b + f.length, f.decimals);
+            }
+            best = std::min(best, Clock::now_ns() - start);
+            do_not_optimize(sum);
+        }
+        return std::pair{static_cast<double>(best) / FIELDS, sum};
+    };
+    auto [scalar_ns, scalar_sum] = run([](const char* b, const char* e, uint32_t d) {
+        return DecimalParser::parse_fixed_scalar(b, e, d);
+    });
+    auto [swar_ns, swar_sum] = run([](const char* b, const char* e, uint32_t d) {
+        return DecimalParser::parse_fixed(b, e, d);
+    });
+
+    printf("  Field parse scalar: %.2f ns/field\n", scalar_ns);
+    printf("  Field parse SWAR:   %.2f ns/field (%.2fx)\n", swar_ns, scalar_ns / swar_ns);
+    return scalar_sum == swar_sum;
+}
+
+/// End-to-end run (engine -> `Queue` -> strategy) with the engine
+/// publishing notifications `batch` at a time through push_bulk (batch 1
+/// builds each one in its slot with emplace). Returns
+/// {avg, min} wall time over BENCH_ITERATIONS; `stats` gets the last run.
+template <typename Queue = SPSCQueue<BookNotification, QUEUE_CAPACITY>>
+static std::pair<uint64_t, uint64_t> bench_e2e(const UpdateLog& feed, size_t batch,
+                                                StrategyStats& stats) {
+    std::vector<uint64_t> e2e_times;
+    e2e_times.reserve(BENCH_ITERATIONS);
+    std::vector<BookNotification> pending;
+    pending.reserve(batch);
+
+    for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+        auto queue = std::make_unique<Queue>();
+        std::atomic<bool> closed{false};
+
+        auto* qp = queue.get();
+        std::thread strat([qp, &closed, &stats]() {
+            stats = run_strategy(*qp, closed, false);
+        });
+
+        Orderbook book;
+        uint64_t start = Clock::now_ns();
+        for (const auto& u : feed.updates) {
+            uint64_t now = Clock::now_ns();
+            if (batch == 1) {
+                book.advance(u, feed.levels);
+                qp->emplace(u.timestamp, now, book.best_bid(), book.best_ask(), book.seq());
+                continue;
+            }
+            pending.push_back(book.apply(u, feed.levels, now));
+            if (pending.size() == batch) {
+                qp->push_bulk(pending);
+                pending.clear();
+            }
+        }
+        qp->push_bulk(pending);
+        pending.clear();
+        closed.store(true, std::memory_order_release);
+        strat.join();
+        uint64_t end = Clock::now_ns();
+        e2e_times.push_back(end - start);
+    }
+
+    uint64_t avg = 0;
+    for (auto t : e2e_times) avg += t;
+    avg /= e2e_times.size();
+    return {avg, *std::min_element(e2e_times.begin(), e2e_times.end())};
+}
+
+/// One e2e row for queue type `Queue`: throughput plus median and p99
+/// engine -> strategy latency of the last run.
+template <typename Queue>
+static void report_queue(const char* name, const UpdateLog& feed) {
+    StrategyStats stats;
+    const uint64_t min_e2e = bench_e2e<Queue>(feed, 1, stats).second;
+    printf("    %-18s %12.0f updates/sec   median %7lu ns   p99 %7lu ns   (%zu KiB)\n",
+           name, feed.size() * 1e9 / min_e2e, stats.median(), stats.percentile(99.0),
+           sizeof(Queue) / 1024);
+}
+
+/// Raw channel throughput with no book work: a producer thread hands
+/// notifications to a consumer thread through `Queue`. With `Batch` 1 each
+/// side moves one element per call (push / pop); above it, `Batch` per
+/// call (push_bulk / pop_bulk). Best of RUNS in notifications/sec, or 0 if
+/// any notification went missing.
+template <typename Queue, size_t Batch = 1>
+static double transfer_rate() {
+    constexpr int RUNS = 3;
+    constexpr uint64_t COUNT = 1 << 17;
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r < RUNS; ++r) {
+        auto queue = std::make_unique<Queue>();
+        auto* qp = queue.get();
+        std::atomic<bool> closed{false};
+        uint64_t received = 0;
+        std::thread consumer([qp, &closed, &received]() {
+            if constexpr (Batch == 1) {
+                while (qp->pop(closed)) ++received;
+            } else {
+                BookNotification out[Batch];
+                while (size_t n = qp->pop_bulk(out, closed)) received += n;
+            }
+        });
+
+        const uint64_t start = Clock::now_ns();
+        if constexpr (Batch == 1) {
+            for (uint64_t i = 0; i < COUNT; ++i) qp->push(BookNotification{i, start, {}, {}, i});
+        } else {
+            BookNotification pending[Batch];
+            for (uint64_t i = 0; i < COUNT; i += Batch) {
+                for (size_t j = 0; j < Batch; ++j) pending[j] = BookNotification{i + j, start, {}, {}, i + j};
+                qp->push_bulk(pending);
+            }
+        }
+        closed.store(true, std::memory_order_release);
+        consumer.join();
+        if (received != COUNT) return 0;
+        best = std::min(best, Clock::now_ns() - start);
+    }
+    return COUNT * 1e9 / best;
+}
+
+/// SPSCQueue against the per-slot-sequence queue it replaced, element at a
+/// time and in batches. Returns false if a queue lost notifications.
+static bool report_queue_transfer() {
+    const double baseline = transfer_rate<SeqSPSCQueue<BookNotification, QUEUE_CAPACITY>>();
+    const double single = transfer_rate<SPSCQueue<BookNotification, QUEUE_CAPACITY>>();
+    const double bulk = transfer_rate<SPSCQueue<BookNotification, QUEUE_CAPACITY>, 64>();
+    printf("  Queue transfer (no book work):\n");
+    printf("    %-26s %12.0f notifications/sec\n", "SeqSPSCQueue (baseline)", baseline);
+    printf("    %-26s %12.0f notifications/sec   %.2fx\n", "SPSCQueue push/pop", single,
+           baseline > 0 ? single / baseline : 0.0);
+    printf("    %-26s %12.0f notifications/sec   %.2fx\n", "SPSCQueue bulk 64", bulk,
+           baseline > 0 ? bulk / baseline : 0.0);
+    return baseline > 0 && single > 0 && bulk > 0;
+}
+
+/// Engine paced at one update per `gap_ns` feeding a strategy that spends
+/// `work_ns` per notification, so the strategy falls behind: a queue
+/// delivers every stale notification in order, a ConflatingSlot only the
+/// latest. Prints delivered and conflated counts and the latency at which
+/// the strategy picked each notification up.
+static void report_slow_consumer(const UpdateLog& feed, uint64_t gap_ns, uint64_t work_ns) {
+    auto run = [&](const char* name, bool conflate) {
+        StrategyStats stats;
+        auto queue = std::make_unique<SPSCQueue<BookNotification, QUEUE_CAPACITY>>();
+        auto latest = std::make_unique<ConflatingSlot<BookNotification>>();
+        std::atomic<bool> closed{false};
+        std::thread strat([&]() {
+            stats = conflate ? run_strategy(*latest, closed, false, Instrument::btc_usdt(), work_ns)
+                             : run_strategy(*queue, closed, false, Instrument::btc_usdt(), work_ns);
+        });
+
+        Orderbook book;
+        for (const auto& u : feed.updates) {
+            uint64_t now = Clock::now_ns();
+            while (Clock::now_ns() - now < gap_ns) cpu_relax();
+            now = Clock::now_ns();
+            book.advance(u, feed.levels);
+            if (conflate) {
+                latest->publish(BookNotification{u.timestamp, now, book.best_bid(), book.best_ask(), book.seq()});
+            } else {
+                queue->emplace(u.timestamp, now, book.best_bid(), book.best_ask(), book.seq());
+            }
+        }
+        closed.store(true, std::memory_order_release);
+        strat.join();
+
+        printf("    %-18s delivered %6lu   conflated %6lu   median %9lu ns   p99 %9lu ns\n",
+               name, stats.count, stats.conflated, stats.median(), stats.percentile(99.0));
+    };
+    printf("  Slow strategy (%lu ns/notification, feed every %lu ns):\n", work_ns, gap_ns);
+    run("SPSCQueue", false);
+    run("ConflatingSlot", true);
+}
+
+/// Engine -> BroadcastRing -> `strategies` strategy threads plus a
+/// recorder behind all of them. Prints e2e throughput and each consumer's
+/// median / p99 latency for the best of RUNS runs.
+static void report_fan_out(const UpdateLog& feed, unsigned strategies) {
+    using Ring = BroadcastRing<BookNotification, QUEUE_CAPACITY>;
+    constexpr int RUNS = 5;
+    uint64_t best = UINT64_MAX;
+    std::vector<StrategyStats> best_stats;
+
+    for (int r = 0; r < RUNS; ++r) {
+        auto ring = std::make_unique<Ring>();
+        std::vector<uint32_t> all_strategies;
+        for (uint32_t i = 0; i < strategies; ++i) {
+            ring->add_consumer();
+            all_strategies.push_back(i);
+        }
+        ring->add_consumer(all_strategies);
+
+        std::atomic<bool> closed{false};
+        std::vector<StrategyStats> stats(strategies + 1);
+        std::vector<BookNotification> journal;
+        journal.reserve(feed.size());
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i <= strategies; ++i) {
+            threads.emplace_back([&, i]() {
+                stats[i] = (i < strategies) ? run_strategy(*ring, i, closed, false)
+                                            : run_recorder(*ring, i, closed, journal);
+            });
+        }
+
+        Orderbook book;
+        uint64_t start = Clock::now_ns();
+        for (const auto& u : feed.updates) {
+            uint64_t now = Clock::now_ns();
+            book.advance(u, feed.levels);
+            ring->emplace(u.timestamp, now, book.best_bid(), book.best_ask(), book.seq());
+        }
+        closed.store(true, std::memory_order_release);
+        for (auto& t : threads) t.join();
+        uint64_t elapsed = Clock::now_ns() - start;
+        if (elapsed < best) {
+            best = elapsed;
+            best_stats = std::move(stats);
+        }
+    }
+
+    printf("  %u strateg%s + recorder: %12.0f updates/sec\n", strategies,
+           strategies == 1 ? "y" : "ies", feed.size() * 1e9 / best);
+    for (unsigned i = 0; i <= strategies; ++i) {
+        char name[16];
+        if (i < strategies) {
+            snprintf(name, sizeof(name), "strategy %u", i);
+        } else {
+            snprintf(name, sizeof(name), "recorder");
+        }
+        printf("    %-12s received %6lu   median %9lu ns   p99 %9lu ns\n", name,
+               best_stats[i].count, best_stats[i].median(), best_stats[i].percentile(99.0));
+    }
+}
+
+/// Snapshot-heavy text: `count` snapshot lines of `depth` levels per side,
+/// in the feed's "[[price, size], ...]" layout.
+static std::string make_snapshot_csv(size_t depth, size_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::string out;
+    char buf[64];
+    auto side = [&](uint64_t touch, int step) {
+        out += "\"[";
+        uint64_t px = touch;
+        for (size_t i = 0; i < depth; ++i) {
+            int n = snprintf(buf, sizeof(buf), "%s[%llu.%02llu, %llu.%04llu]", i ? ", " : "",
+                             static_cast<unsigned long long>(px / 100),
+                             static_cast<unsigned long long>(px % 100),
+                             static_cast<unsigned long long>(rng() % 10),
+                             static_cast<unsigned long long>(rng() % 10'000));
+            out.append(buf, n);
+            px += step * static_cast<int>(1 + rng() % 3);
+        }
+        out += "]\"";
+    };
+    for (size_t s = 0; s < count; ++s) {
+        int n = snprintf(buf, sizeof(buf), "snapshot,binance,BTC/USDT,%llu,,",
+                         static_cast<unsigned long long>(1'700'000'000'000ULL + s));
+        out.append(buf, n);
+        side(9'999'999, -1);
+        out += ',';
+        side(10'000'001, 1);
+        out += ",,\n";
+    }
+    return out;
+}
+
+/// Snapshot level arrays: byte-at-a-time state machine vs counted,
+/// exactly-sized fast path, plus a full parse_buffer of snapshot lines
+/// against a plain memcpy of the same bytes. Returns false on mismatch.
+static bool report_snapshot_levels() {
+    constexpr int RUNS = 5;
+    constexpr double MB = 1024.0 * 1024.0;
+    const Instrument inst = Instrument::btc_usdt();
+    bool match = true;
+
+    for (size_t depth : {1000, 5000}) {
+        const std::string text = make_snapshot_csv(depth, 20'000 / depth * 16, depth);
+        // The quoted arrays, as parse_snapshot hands them over.
+        std::vector<std::string_view> arrays;
+        for (size_t q = text.find('"'); q != std::string::npos; q = text.find('"', q + 1)) {
+            const size_t close = text.find('"', q + 1);
+            arrays.emplace_back(text.data() + q + 1, close - q - 1);
+            q = close;
+        }
+
+        auto run = [&](auto parse, std::vector<Level>& levels) {
+            uint64_t best = UINT64_MAX;
+            for (int r = 0; r < RUNS; ++r) {
+                levels = std::vector<Level>{};
+                const uint64_t start = Clock::now_ns();
+                for (std::string_view a : arrays) parse(a, inst, levels);
+                best = std::min(best, Clock::now_ns() - start);
+            }
+            return text.size() * 1e9 / best;
+        };
+        std::vector<Level> scalar_levels, fast_levels;
+        const double scalar_tp = run(CsvReader::parse_levels_json_scalar, scalar_levels);
+        const double fast_tp = run(CsvReader::parse_levels_json, fast_levels);
+        match = match && scalar_levels == fast_levels;
+
+        uint64_t best_parse = UINT64_MAX, best_copy = UINT64_MAX;
+        std::string copy(text.size(), '\0');
+        for (int r = 0; r < RUNS; ++r) {
+            UpdateLog out;
+            uint64_t start = Clock::now_ns();
+            CsvReader::parse_buffer(text.data(), text.size(), inst, out);
+            best_parse = std::min(best_parse, Clock::now_ns() - start);
+            match = match && out.levels.size() == fast_levels.size();
+
+            start = Clock::now_ns();
+            memcpy(copy.data(), text.data(), text.size());
+            best_copy = std::min(best_copy, Clock::now_ns() - start);
+            do_not_optimize(copy[r]);
+        }
+
+        printf("  Snapshots, %zu levels/side (%zu lines, %.1f MB):\n",
+               depth, arrays.size() / 2, text.size() / MB);
+        printf("    levels scalar:    %8.1f MB/s\n", scalar_tp / MB);
+        printf("    levels counted:   %8.1f MB/s (%.2fx)\n", fast_tp / MB, fast_tp / scalar_tp);
+        printf("    full parse:       %8.1f MB/s (memcpy %.1f MB/s)\n",
+               text.size() * 1e9 / best_parse / MB, text.size() * 1e9 / best_copy / MB);
+    }
+    return match;
+}
+
+/// CSV body (header stripped) of `path`, repeated until it is at least
+/// `min_bytes` long, so scan throughput is measured on a large buffer.
+static std::string replicate_csv_body(const char* path, size_t min_bytes) {
+    std::string file;
+    if (FILE* f = fopen(path, "rb")) {
+        char buf[1 << 16];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) file.append(buf, n);
+        fclose(f);
+    }
+    size_t nl = file.find('\n');
+    std::string body = (nl == std::string::npos) ? std::string() : file.substr(nl + 1);
+    if (body.empty()) return body;
+    if (body.back() != '\n') body.push_back('\n');
+
+    std::string out;
+    out.reserve(min_bytes + body.size());
+    while (out.size() < min_bytes) out += body;
+    return out;
+}
+
+/// Bytes/sec of the structural index alone and of a full parse_buffer
+/// with block classifier `Scanner`; the parsed updates land in `out`.
+template <typename Scanner>
+static std::pair<double, double> scan_throughput(const std::string& text, UpdateLog& out) {
+    constexpr int RUNS = 5;
+    uint64_t best_index = UINT64_MAX, best_parse = UINT64_MAX;
+    for (int r = 0; r < RUNS; ++r) {
+        // Stage 1 only: structural masks over every full block.
+        StructuralIndex<Scanner> index;
+        uint64_t fields = 0;
+        uint64_t start = Clock::now_ns();
+        for (size_t off = 0; off + 64 <= text.size(); off += 64) {
+            auto s = index.next(text.data() + off);
+            fields += std::popcount(s.comma | s.newline);
+        }
+        best_index = std::min(best_index, Clock::now_ns() - start);
+        do_not_optimize(fields);
+
+        out = UpdateLog{};
+        out.reserve(text.size() / 64);
+        start = Clock::now_ns();
+        CsvReader::parse_buffer<UpdateLog, Scanner>(text.data(), text.size(),
+                                                    Instrument::btc_usdt(), out);
+        best_parse = std::min(best_parse, Clock::now_ns() - start);
+    }
+    return {text.size() * 1e9 / best_index, text.size() * 1e9 / best_parse};
+}
+
+/// Scalar vs SIMD block classification on a large replicated buffer.
+/// Returns false if the two produce different updates.
+static bool report_scan_throughput(const std::string& text) {
+    if (text.empty()) return true;
+
+    UpdateLog scalar_out, simd_out;
+    auto [scalar_index, scalar_parse] = scan_throughput<ScalarBlockScanner>(text, scalar_out);
+    auto [simd_index, simd_parse] = scan_throughput<SimdBlockScanner>(text, simd_out);
+
+    constexpr double MB = 1024.0 * 1024.0;
+    printf("  Scan buffer:        %.1f MB (%zu updates)\n", text.size() / MB, simd_out.size());
+    char simd_label[32];
+    snprintf(simd_label, sizeof(simd_label), "Structural %s:", SimdBlockScanner::NAME);
+    printf("  %-20s%8.1f MB/s   full parse %7.1f MB/s\n",
+           "Structural scalar:", scalar_index / MB, scalar_parse / MB);
+    printf("  %-20s%8.1f MB/s   full parse %7.1f MB/s (%.2fx)\n",
+           simd_label, simd_index / MB, simd_parse / MB, simd_parse / scalar_parse);
+
+    return scalar_out == simd_out;
+}
+
+/// Best-of-N pull of the whole file through a CsvStream with a small
+/// window: total throughput and time until the first batch is ready.
+static void report_stream_parse(const char* path) {
+    constexpr int RUNS = 5;
+    constexpr size_t WINDOW = 64 * 1024;
+    uint64_t best_total = UINT64_MAX, best_first = UINT64_MAX;
+    size_t count = 0;
+    UpdateLog batch;
+    for (int r = 0; r < RUNS; ++r) {
+        uint64_t start = Clock::now_ns();
+        CsvStream stream(path, Instrument::btc_usdt(), WINDOW);
+        count = 0;
+        bool first = true;
+        while (stream.next_batch(batch)) {
+            if (first) best_first = std::min(best_first, Clock::now_ns() - start);
+            first = false;
+            count += batch.size();
+        }
+        best_total = std::min(best_total, Clock::now_ns() - start);
+    }
+    printf("  Stream parse:       %.0f updates/sec (%zu KiB window), first batch after %.2f us\n",
+           count * 1e9 / best_total, WINDOW / 1024, best_first / 1000.0);
+}
+
+/// Parallel parse speedup over the serial parse_buffer on the replicated
+/// buffer, doubling the thread count. Returns false if any output differs
+/// from the serial one byte for byte.
+static bool report_parallel_parse(const std::string& text) {
+    if (text.empty()) return true;
+    constexpr int RUNS = 3;
+    constexpr double MB = 1024.0 * 1024.0;
+    const Instrument inst = Instrument::btc_usdt();
+
+    UpdateLog serial;
+    uint64_t serial_ns = UINT64_MAX;
+    for (int r = 0; r < RUNS; ++r) {
+        serial = UpdateLog{};
+        uint64_t start = Clock::now_ns();
+        CsvReader::parse_buffer(text.data(), text.size(), inst, serial);
+        serial_ns = std::min(serial_ns, Clock::now_ns() - start);
+    }
+
+    const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    const unsigned max_threads = std::max(4u, hw);
+    printf("  Parallel parse (%u hardware threads):\n", hw);
+    printf("    serial      %7.1f MB/s\n", text.size() / MB * 1e9 / serial_ns);
+
+    bool identical = true;
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        UpdateLog par;
+        uint64_t best = UINT64_MAX;
+        for (int r = 0; r < RUNS; ++r) {
+            uint64_t start = Clock::now_ns();
+            par = ParallelCsvReader::parse_buffer(text.data(), text.size(), threads, inst);
+            best = std::min(best, Clock::now_ns() - start);
+        }
+        identical = identical && par == serial;
+        printf("    %2u threads  %7.1f MB/s   %.2fx\n", threads,
+               text.size() / MB * 1e9 / best, static_cast<double>(serial_ns) / best);
+    }
+    return identical;
+}
+
+/// Append-to-notification latency in follow mode: a writer thread appends
+/// one incremental line at a time (timestamp field = Clock::now_ns() at the
+/// write) while the follower applies each update to a book; latency is the
+/// notification time minus that timestamp.
+static void report_follow_latency(CsvStream::Wait wait, const char* name) {
+    constexpr int LINES = 2000;
+    constexpr int GAP_US = 200;
+    const std::string path = "/tmp/orderbook_bench_" + std::to_string(getpid()) + ".follow.csv";
+    int wfd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (wfd < 0) return;
+    static const char header[] = "type,exchange,symbol,timestamp,side,bids,asks,price,size\n";
+    if (write(wfd, header, sizeof(header) - 1) < 0) return;
+
+    std::atomic<bool> stop{false};
+    std::thread writer([&] {
+        char line[128];
+        for (int i = 0; i < LINES; ++i) {
+            int n = snprintf(line, sizeof(line), "incremental,binance,BTC/USDT,%llu,%s,,,%d.%02d,1.5\n",
+                             static_cast<unsigned long long>(Clock::now_ns()),
+                             (i & 1) ? "ask" : "bid", 100000 + (i % 50) * ((i & 1) ? 1 : -1), i % 100);
+            if (write(wfd, line, static_cast<size_t>(n)) < 0) break;
+            std::this_thread::sleep_for(std::chrono::microseconds(GAP_US));
+        }
+    });
+
+    CsvStream reader(path.c_str());
+    reader.follow(&stop, 500, wait);
+    Orderbook book;
+    UpdateLog batch;
+    std::vector<uint64_t> latencies;
+    latencies.reserve(LINES);
+    while (latencies.size() < static_cast<size_t>(LINES) && reader.next_batch(batch)) {
+        for (const auto& u : batch.updates) {
+            uint64_t now = Clock::now_ns();
+            auto notif = book.apply(u, batch.levels, now);
+            latencies.push_back(notif.engine_send_ns - notif.update_timestamp);
+        }
+    }
+    stop.store(true);
+    writer.join();
+    close(wfd);
+    unlink(path.c_str());
+    if (latencies.empty()) return;
+
+    std::sort(latencies.begin(), latencies.end());
+    auto pct = [&](double p) { return latencies[static_cast<size_t>(p / 100.0 * (latencies.size() - 1))]; };
+    printf("    %-8s %zu lines   p50 %7.1f us   p99 %7.1f us   max %7.1f us\n", name,
+           latencies.size(), pct(50) / 1e3, pct(99) / 1e3, latencies.back() / 1e3);
+}
+
+/// Evict `path` from the page cache so the next read goes to the device.
+static void drop_page_cache(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+/// Fraction of `path`'s pages currently in the page cache.
+static double resident_fraction(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0.0;
+    struct stat st;
+    fstat(fd, &st);
+    size_t size = static_cast<size_t>(st.st_size);
+    void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return 0.0;
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    std::vector<unsigned char> vec((size + page - 1) / page);
+    size_t resident = 0;
+    if (mincore(map, size, vec.data()) == 0) {
+        for (unsigned char v : vec) resident += v & 1;
+    }
+    munmap(map, size);
+    return vec.empty() ? 0.0 : static_cast<double>(resident) / vec.size();
+}
+
+/// Parse MB/s of the replicated CSV from a file, warm (page cache hot)
+/// and cold (evicted with POSIX_FADV_DONTNEED before each run), for the
+/// mmap parser and both read-ahead backends. Returns false if any backend's
+/// output differs from the mmap parse.
+static bool report_cold_warm_parse(const std::string& text) {
+    if (text.empty()) return true;
+    constexpr int RUNS = 3;
+    constexpr double MB = 1024.0 * 1024.0;
+    const std::string csv = "/tmp/orderbook_bench_" + std::to_string(getpid()) + ".io.csv";
+    FILE* f = fopen(csv.c_str(), "wb");
+    if (!f) return true;
+    static const char header[] = "type,exchange,symbol,timestamp,side,bids,asks,price,size\n";
+    fwrite(header, 1, sizeof(header) - 1, f);
+    fwrite(text.data(), 1, text.size(), f);
+    fclose(f);
+    const double bytes = static_cast<double>(text.size() + sizeof(header) - 1);
+
+    UpdateLog reference = CsvReader::parse_file(csv.c_str());
+    drop_page_cache(csv.c_str());
+    printf("  Input backends (%.1f MB file; %.0f%% cached after eviction):\n",
+           bytes / MB, 100.0 * resident_fraction(csv.c_str()));
+
+    // Only backends that ran are compared; one that could not start is
+    // reported as unavailable, not as a mismatch.
+    bool identical = true;
+    auto measure = [&](const char* name, auto&& parse) {
+        uint64_t warm = UINT64_MAX, cold = UINT64_MAX;
+        for (int r = 0; r < RUNS; ++r) {
+            drop_page_cache(csv.c_str());
+            UpdateLog out;
+            uint64_t start = Clock::now_ns();
+            const bool ok = parse(out);
+            cold = std::min(cold, Clock::now_ns() - start);
+            identical = identical && ok && out == reference;
+        }
+        for (int r = 0; r < RUNS; ++r) {
+            UpdateLog out;
+            uint64_t start = Clock::now_ns();
+            parse(out);
+            warm = std::min(warm, Clock::now_ns() - start);
+        }
+        printf("    %-14s warm %7.1f MB/s   cold %7.1f MB/s\n",
+               name, bytes / MB * 1e9 / warm, bytes / MB * 1e9 / cold);
+    };
+    measure("mmap", [&](UpdateLog& out) {
+        out = CsvReader::parse_file(csv.c_str());
+        return true;
+    });
+    if (UringReadAhead::available()) {
+        measure(UringReadAhead::NAME, [&](UpdateLog& out) {
+            return AsyncCsvReader::parse_file<UringReadAhead>(csv.c_str(), out);
+        });
+    } else {
+        printf("    %-14s unavailable\n", UringReadAhead::NAME);
+    }
+    measure(ThreadReadAhead::NAME, [&](UpdateLog& out) {
+        return AsyncCsvReader::parse_file<ThreadReadAhead>(csv.c_str(), out);
+    });
+    unlink(csv.c_str());
+    return identical;
+}
+
+/// Load-and-replay on the ladder engine from a raw capture: copied into a
+/// heap UpdateLog vs iterated in place through a CaptureView (with and
+/// without MAP_POPULATE). Returns false if the runs end on different best
+/// bids.
+static bool report_zero_copy_replay(const UpdateLog& feed, const std::string& bin) {
+    constexpr int RUNS = 5;
+    constexpr double MB = 1024.0 * 1024.0;
+    if (!CaptureWriter::write(bin.c_str(), feed, Instrument::btc_usdt())) return false;
+
+    auto time_best = [&](auto&& replay) {
+        uint64_t best = UINT64_MAX;
+        std::optional<Level> bid;
+        for (int r = 0; r < RUNS; ++r) {
+            uint64_t start = Clock::now_ns();
+            bid = replay();
+            best = std::min(best, Clock::now_ns() - start);
+        }
+        return std::pair{best, bid};
+    };
+    auto [copy_ns, copy_bid] = time_best([&] {
+        UpdateLog loaded = CaptureReader::load(bin.c_str());
+        LadderOrderbook book;
+        for (const auto& u : loaded.updates) book.apply(u, loaded.levels, 0);
+        return book.best_bid();
+    });
+    auto view_replay = [&](bool populate) {
+        CaptureView view(bin.c_str(), populate);
+        LadderOrderbook book;
+        view.for_each_chunk([&](std::span<const Update> updates, std::span<const Level> levels) {
+            for (const auto& u : updates) book.apply(u, levels, 0);
+        });
+        return book.best_bid();
+    };
+    auto [view_ns, view_bid] = time_best([&] { return view_replay(false); });
+    auto [pop_ns, pop_bid] = time_best([&] { return view_replay(true); });
+    unlink(bin.c_str());
+
+    printf("  Capture replay (ladder), load + apply:\n");
+    printf("    heap copy       %7.2f ms   (%.1f MB private copy)\n", copy_ns / 1e6,
+           (feed.updates.size() * sizeof(Update) + feed.levels.size() * sizeof(Level)) / MB);
+    printf("    mmap view       %7.2f ms   (%.2fx)\n", view_ns / 1e6,
+           static_cast<double>(copy_ns) / view_ns);
+    printf("    view + populate %7.2f ms   (%.2fx)\n", pop_ns / 1e6,
+           static_cast<double>(copy_ns) / pop_ns);
+
+    auto same = [](const std::optional<Level>& a, const std::optional<Level>& b) {
+        return a.has_value() == b.has_value() &&
+               (!a || (a->price == b->price && a->qty == b->qty));
+    };
+    return same(copy_bid, view_bid) && same(copy_bid, pop_bid);
+}
+
+/// Startup cost for the same replicated feed: parse it from a CSV file vs
+/// load it from a raw and a delta/varint capture. All files are written to
+/// /tmp and read from the page cache. Returns false if a loaded or replayed
+/// feed differs.
+static bool report_capture_load(const std::string& text) {
+    if (text.empty()) return true;
+    constexpr int RUNS = 5;
+    constexpr double MB = 1024.0 * 1024.0;
+    const Instrument inst = Instrument::btc_usdt();
+    const std::string stem = "/tmp/orderbook_bench_" + std::to_string(getpid());
+    const std::string csv = stem + ".csv";
+
+    FILE* f = fopen(csv.c_str(), "wb");
+    if (!f) return true;
+    static const char header[] = "type,exchange,symbol,timestamp,side,bids,asks,price,size\n";
+    fwrite(header, 1, sizeof(header) - 1, f);
+    fwrite(text.data(), 1, text.size(), f);
+    fclose(f);
+
+    UpdateLog parsed;
+    uint64_t best_csv = UINT64_MAX;
+    for (int r = 0; r < RUNS; ++r) {
+        uint64_t start = Clock::now_ns();
+        parsed = CsvReader::parse_file(csv.c_str(), inst);
+        best_csv = std::min(best_csv, Clock::now_ns() - start);
+    }
+    unlink(csv.c_str());
+    printf("  Startup, %zu updates:\n", parsed.size());
+    printf("    CSV parse       %6.1f MB  %7.2f ms\n", text.size() / MB, best_csv / 1e6);
+
+    bool identical = true;
+    const std::pair<const char*, CaptureEncoding> encodings[] = {
+        {"raw", CaptureEncoding::Raw}, {"delta", CaptureEncoding::DeltaVarint}};
+    for (auto [name, encoding] : encodings) {
+        const std::string bin = stem + "." + name + ".bin";
+        if (!CaptureWriter::write(bin.c_str(), parsed, inst, encoding)) return false;
+
+        UpdateLog loaded;
+        uint64_t best = UINT64_MAX;
+        for (int r = 0; r < RUNS; ++r) {
+            uint64_t start = Clock::now_ns();
+            loaded = CaptureReader::load(bin.c_str());
+            best = std::min(best, Clock::now_ns() - start);
+        }
+        struct stat st{};
+        stat(bin.c_str(), &st);
+        unlink(bin.c_str());
+
+        printf("    capture %-6s  %6.1f MB  %7.2f ms   %5.1fx faster, %4.1fx smaller\n",
+               name, st.st_size / MB, best / 1e6, static_cast<double>(best_csv) / best,
+               text.size() / static_cast<double>(st.st_size));
+        identical = identical && loaded == parsed;
+    }
+    return report_zero_copy_replay(parsed, stem + ".view.bin") && identical;
+}
+
+/// Best-of-N replay of the same updates on the ladder engine, once from the
+/// Update array and once from the columnar store.
+static void report_replay(const char* name, const UpdateLog& feed, const UpdateColumns& cols) {
+    constexpr int RUNS = 5;
+
+    uint64_t best_rows = UINT64_MAX, best_cols = UINT64_MAX;
+    for (int i = 0; i < RUNS; ++i) {
+        LadderOrderbook book;
+        uint64_t start = Clock::now_ns();
+        for (const auto& u : feed.updates) book.apply(u, feed.levels, 0);
+        best_rows = std::min(best_rows, Clock::now_ns() - start);
+        do_not_optimize(book.best_bid());
+    }
+    for (int i = 0; i < RUNS; ++i) {
+        LadderOrderbook book;
+        uint64_t start = Clock::now_ns();
+        replay_columns(book, cols);
+        best_cols = std::min(best_cols, Clock::now_ns() - start);
+        do_not_optimize(book.best_bid());
+    }
+
+    constexpr size_t touched = sizeof(Update::Type) + sizeof(Side) + sizeof(Price) + sizeof(Qty);
+    printf("  %-22s rows %6.1f ns/upd (%zu B)   columns %6.1f ns/upd (%zu B)   %.2fx\n",
+        name,
+        static_cast<double>(best_rows) / feed.size(), sizeof(Update),
+        static_cast<double>(best_cols) / feed.size(), touched,
+        static_cast<double>(best_rows) / best_cols);
+}
+
 int main(int argc, char* argv[]) {
-    const char* csv_path = (argc > 1) ? argv[1] : "btc_orderbook_updates.csv";
+    // Default: the baseline sections on the dataset, fast enough for
+    // compare_benchmarks.sh to run 100 times. --extended adds the large
+    // replicated feed, I/O backends, follow mode, synthetic books and
+    // channel variants (tens of seconds).
+    const char* csv_path = "btc_orderbook_updates.csv";
+    bool extended = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--extended") == 0) {
+            extended = true;
+        } else {
+            csv_path = argv[i];
+        }
+    }
 
     printf("╔══════════════════════════════════════════════════════╗\n");
     printf("║    ORDERBOOK SYSTEM (C++) — BENCHMARK SUITE         ║\n");
@@ -36,16 +1005,16 @@ int main(int argc, char* argv[]) {
     printf("── Benchmark 1: CSV Parsing ──────────────────────────\n");
 
     // Warmup
-    std::vector<Update> updates;
+    UpdateLog feed;
     for (int i = 0; i < WARMUP_ITERATIONS; ++i) {
-        updates = CsvReader::parse_file(csv_path);
+        feed = CsvReader::parse_file(csv_path);
     }
 
     std::vector<uint64_t> parse_times;
     parse_times.reserve(BENCH_ITERATIONS);
     for (int i = 0; i < BENCH_ITERATIONS; ++i) {
         uint64_t start = Clock::now_ns();
-        updates = CsvReader::parse_file(csv_path);
+        feed = CsvReader::parse_file(csv_path);
         uint64_t end = Clock::now_ns();
         parse_times.push_back(end - start);
     }
@@ -54,88 +1023,91 @@ int main(int argc, char* argv[]) {
     for (auto t : parse_times) avg_parse += t;
     avg_parse /= parse_times.size();
     uint64_t min_parse = *std::min_element(parse_times.begin(), parse_times.end());
-    double parse_tp = (updates.size() / static_cast<double>(min_parse)) * 1e9;
+    double parse_tp = (feed.size() / static_cast<double>(min_parse)) * 1e9;
 
-    printf("  Updates parsed:    %zu\n", updates.size());
+    printf("  Updates parsed:    %zu\n", feed.size());
     printf("  Avg parse time:    %.2f us\n", avg_parse / 1000.0);
     printf("  Min parse time:    %.2f us\n", min_parse / 1000.0);
-    printf("  Parse throughput:  %.0f updates/sec (best run)\n\n", parse_tp);
+    printf("  Parse throughput:  %.0f updates/sec (best run)\n", parse_tp);
+    if (extended) {
+        if (!report_decimal_fields()) printf("  Field parse:        SWAR/scalar MISMATCH\n");
+        if (!report_snapshot_levels()) printf("  Snapshot levels:    fast/scalar MISMATCH\n");
+        report_stream_parse(csv_path);
+        const std::string text = replicate_csv_body(csv_path, 64u << 20);
+        if (!report_scan_throughput(text)) printf("  Structural scan:    SIMD/scalar MISMATCH\n");
+        if (!report_parallel_parse(text)) printf("  Parallel parse:     MISMATCH vs serial\n");
+        if (!report_capture_load(text)) printf("  Capture load:       MISMATCH vs CSV parse\n");
+        if (!report_cold_warm_parse(text)) printf("  Input backends:     MISMATCH vs mmap parse\n");
+        printf("  Follow mode, append -> BookNotification:\n");
+        report_follow_latency(CsvStream::Wait::Inotify, "inotify");
+        report_follow_latency(CsvStream::Wait::Poll, "poll");
+    }
+    printf("\n");
 
     // ── Benchmark 2: Orderbook Engine (isolated) ──
     printf("── Benchmark 2: Orderbook Engine (isolated) ──────────\n");
 
-    // Warmup
-    for (int i = 0; i < WARMUP_ITERATIONS; ++i) {
-        Orderbook book;
-        for (const auto& u : updates) book.apply(u, 0);
-    }
+    auto map_times = bench_engine<Orderbook>(feed);
+    uint64_t avg_engine = map_times.avg_ns;
+    uint64_t min_engine = map_times.min_ns;
+    double per_update = static_cast<double>(min_engine) / feed.size();
+    double engine_tp = (feed.size() / static_cast<double>(min_engine)) * 1e9;
 
-    std::vector<uint64_t> engine_times;
-    engine_times.reserve(BENCH_ITERATIONS);
-    for (int i = 0; i < BENCH_ITERATIONS; ++i) {
-        Orderbook book;
-        uint64_t start = Clock::now_ns();
-        for (const auto& u : updates) {
-            book.apply(u, 0);
-        }
-        uint64_t end = Clock::now_ns();
-        engine_times.push_back(end - start);
-        do_not_optimize(book.best_bid());
-    }
-
-    uint64_t avg_engine = 0;
-    for (auto t : engine_times) avg_engine += t;
-    avg_engine /= engine_times.size();
-    uint64_t min_engine = *std::min_element(engine_times.begin(), engine_times.end());
-    double per_update = static_cast<double>(min_engine) / updates.size();
-    double engine_tp = (updates.size() / static_cast<double>(min_engine)) * 1e9;
-
-    printf("  Updates:           %zu\n", updates.size());
+    printf("  Updates:           %zu\n", feed.size());
     printf("  Avg engine time:   %.2f us\n", avg_engine / 1000.0);
     printf("  Min engine time:   %.2f us\n", min_engine / 1000.0);
     printf("  Per-update:        %.0f ns\n", per_update);
     printf("  Engine throughput: %.0f updates/sec (best run)\n\n", engine_tp);
 
+    // ── Benchmark 2b: every level-store policy on the same updates ──
+    printf("── Benchmark 2b: Level-Store Policies (isolated) ─────\n");
+    printf("  Dataset (%zu updates):\n", feed.size());
+    compare_policies(feed);
+    if (extended) {
+        for (size_t depth : {1000, 5000}) {
+            auto synthetic = make_synthetic_updates(depth, 200'000, depth);
+            printf("  Synthetic, %zu levels/side (%zu updates):\n", depth, synthetic.size());
+            compare_policies(synthetic);
+        }
+    }
+    printf("\n");
+
+    // ── Benchmark 2c: array-of-structs vs columnar replay ──
+    if (extended) {
+        printf("── Benchmark 2c: Columnar Replay (ladder engine) ──────\n");
+        report_replay("Dataset", feed, CsvReader::parse_file_as<UpdateColumns>(csv_path));
+        auto long_feed = make_synthetic_updates(1000, 2'000'000, 42);
+        report_replay("Synthetic, 2M updates", long_feed, UpdateColumns::from_log(long_feed));
+        printf("\n");
+    }
+
     // ── Benchmark 3: End-to-End ──
     printf("── Benchmark 3: End-to-End (engine + channel + strategy) ──\n");
 
-    std::vector<uint64_t> e2e_times;
-    e2e_times.reserve(BENCH_ITERATIONS);
     StrategyStats last_stats;
-
-    for (int i = 0; i < BENCH_ITERATIONS; ++i) {
-        auto queue = std::make_unique<SPSCQueue<BookNotification, QUEUE_CAPACITY>>();
-        std::atomic<bool> closed{false};
+    double e2e_tp = 0;
+    for (size_t batch : {1, 8, 64}) {
+        if (batch > 1 && !extended) break;
         StrategyStats stats;
-
-        auto* qp = queue.get();
-        std::thread strat([qp, &closed, &stats]() {
-            stats = run_strategy(*qp, closed, false);
-        });
-
-        Orderbook book;
-        uint64_t start = Clock::now_ns();
-        for (const auto& u : updates) {
-            uint64_t now = Clock::now_ns();
-            auto notif = book.apply(u, now);
-            qp->push(notif);
+        auto [avg_e2e, min_e2e] = bench_e2e(feed, batch, stats);
+        double tp = (feed.size() / static_cast<double>(min_e2e)) * 1e9;
+        if (batch == 1) {
+            e2e_tp = tp;
+            last_stats = std::move(stats);
         }
-        closed.store(true, std::memory_order_release);
-        strat.join();
-        uint64_t end = Clock::now_ns();
-        e2e_times.push_back(end - start);
-        last_stats = stats;
+        printf("  Publish batch %-3zu   avg %9.2f us   min %9.2f us   %12.0f updates/sec\n",
+               batch, avg_e2e / 1000.0, min_e2e / 1000.0, tp);
     }
-
-    uint64_t avg_e2e = 0;
-    for (auto t : e2e_times) avg_e2e += t;
-    avg_e2e /= e2e_times.size();
-    uint64_t min_e2e = *std::min_element(e2e_times.begin(), e2e_times.end());
-    double e2e_tp = (updates.size() / static_cast<double>(min_e2e)) * 1e9;
-
-    printf("  Avg e2e time:      %.2f us\n", avg_e2e / 1000.0);
-    printf("  Min e2e time:      %.2f us\n", min_e2e / 1000.0);
-    printf("  E2E throughput:    %.0f updates/sec (best run)\n\n", e2e_tp);
+    if (extended) {
+        printf("  Queue variants (batch 1):\n");
+        report_queue<SPSCQueue<BookNotification, QUEUE_CAPACITY>>("SPSCQueue", feed);
+        report_queue<SPSCRing<BookNotification, QUEUE_CAPACITY>>("SPSCRing (cached)", feed);
+        if (!report_queue_transfer()) printf("  Queue transfer:     LOST notifications\n");
+        report_slow_consumer(feed, 500, 2000);
+        printf("  Fan-out through one broadcast ring:\n");
+        for (unsigned k : {1u, 2u, 4u}) report_fan_out(feed, k);
+    }
+    printf("\n");
 
     // ── Benchmark 4: Latency ──
     printf("── Benchmark 4: Engine -> Strategy Latency ────────────\n");
@@ -0,0 +1,147 @@
+#pragma once
+/// Single-producer, multi-consumer broadcast ring (LMAX Disruptor style).
+/// Every consumer sees every element, read in place from the one shared
+/// ring, so fanning out to N strategies costs no copies. Each consumer owns
+/// a cursor (elements it has finished with) on its own cache line. The
+/// producer only overwrites a slot once every consumer has moved past it,
+/// so the slowest consumer gates the producer. A consumer may also depend
+/// on other consumers (e.g. a recorder after the strategies): it then only
+/// reads elements that all of those have finished with.
+///
+/// Both sides cache the cursor they wait on and only reload it when the
+/// cached value says they must wait, as in SPSCRing. Consumers must be
+/// registered before the producer starts. T must be trivially destructible
+/// (slots are overwritten without running a destructor).
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include "spsc_queue.h"
+
+template <typename T, size_t Capacity>
+class BroadcastRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be power of 2");
+    static_assert(std::is_trivially_destructible_v<T>, "BroadcastRing overwrites slots in place");
+    static constexpr size_t MASK = Capacity - 1;
+
+public:
+    static constexpr size_t CAPACITY = Capacity;
+    static constexpr size_t MAX_CONSUMERS = 16;
+
+private:
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* ptr() { return reinterpret_cast<T*>(storage); }
+    };
+
+    struct alignas(CACHE_LINE) Consumer {
+        std::atomic<uint64_t> cursor{0};      // elements finished with; consumer stores
+        uint64_t barrier_cache = 0;           // consumer-local view of what it may read
+        uint32_t deps[MAX_CONSUMERS];         // consumers this one reads behind
+        uint32_t dep_count = 0;
+    };
+
+    // Producer line: published count plus its view of the slowest consumer.
+    alignas(CACHE_LINE) std::atomic<uint64_t> published_{0};
+    uint64_t gate_cache_ = 0;
+    uint32_t consumer_count_ = 0;
+    Consumer consumers_[MAX_CONSUMERS];
+    alignas(CACHE_LINE) Slot slots_[Capacity];
+
+public:
+    /// Register a consumer reading behind the producer, or behind every
+    /// consumer in `deps` (ids returned by earlier calls). Returns its id,
+    /// or -1 if MAX_CONSUMERS are already registered or a dependency is not
+    /// an earlier consumer (nothing is registered then).
+    int add_consumer(std::span<const uint32_t> deps = {}) {
+        if (consumer_count_ == MAX_CONSUMERS || deps.size() > consumer_count_) return -1;
+        for (uint32_t d : deps) {
+            if (d >= consumer_count_) return -1;
+        }
+        Consumer& c = consumers_[consumer_count_];
+        for (uint32_t d : deps) c.deps[c.dep_count++] = d;
+        return static_cast<int>(consumer_count_++);
+    }
+
+    uint32_t consumer_count() const { return consumer_count_; }
+
+    /// Blocking emplace — builds the element in the next slot once the
+    /// slowest consumer has released it, then publishes it.
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        const uint64_t seq = published_.load(std::memory_order_relaxed);
+        while (seq - gate_cache_ >= Capacity) {
+            gate_cache_ = slowest_cursor();
+            if (seq - gate_cache_ < Capacity) break;
+            cpu_relax();
+        }
+        new (slots_[seq & MASK].storage) T(std::forward<Args>(args)...);
+        published_.store(seq + 1, std::memory_order_release);
+    }
+
+    /// Number of elements consumer `id` may read in place. Spins until there
+    /// is at least one; returns 0 only if `closed` is set and everything
+    /// upstream of `id` has been read.
+    size_t wait_ready(uint32_t id, const std::atomic<bool>& closed) {
+        while (true) {
+            if (size_t n = ready(id)) return n;
+            if (closed.load(std::memory_order_acquire)) {
+                // The producer is done; upstream consumers may still be
+                // draining, so only stop once this one has read everything.
+                const uint64_t published = published_.load(std::memory_order_acquire);
+                Consumer& c = consumers_[id];
+                const uint64_t cursor = c.cursor.load(std::memory_order_relaxed);
+                c.barrier_cache = barrier(c);
+                if (c.barrier_cache != cursor) return c.barrier_cache - cursor;
+                if (cursor == published) return 0;
+            }
+            cpu_relax();
+        }
+    }
+
+    /// Elements consumer `id` may read now (0 if none).
+    size_t ready(uint32_t id) {
+        Consumer& c = consumers_[id];
+        const uint64_t cursor = c.cursor.load(std::memory_order_relaxed);
+        if (c.barrier_cache == cursor) c.barrier_cache = barrier(c);
+        return c.barrier_cache - cursor;
+    }
+
+    /// The i-th unread element of consumer `id`. Requires i < ready(id).
+    const T& front(uint32_t id, size_t i = 0) {
+        const uint64_t cursor = consumers_[id].cursor.load(std::memory_order_relaxed);
+        return *slots_[(cursor + i) & MASK].ptr();
+    }
+
+    /// Consumer `id` is finished with its next `n` elements.
+    void commit(uint32_t id, size_t n) {
+        Consumer& c = consumers_[id];
+        c.cursor.store(c.cursor.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+private:
+    /// How far consumer `c` may read: the producer's count, or the slowest
+    /// of its dependencies.
+    uint64_t barrier(const Consumer& c) const {
+        if (c.dep_count == 0) return published_.load(std::memory_order_acquire);
+        uint64_t b = UINT64_MAX;
+        for (uint32_t i = 0; i < c.dep_count; ++i) {
+            b = std::min(b, consumers_[c.deps[i]].cursor.load(std::memory_order_acquire));
+        }
+        return b;
+    }
+
+    uint64_t slowest_cursor() const {
+        uint64_t slowest = published_.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < consumer_count_; ++i) {
+            slowest = std::min(slowest, consumers_[i].cursor.load(std::memory_order_acquire));
+        }
+        return slowest;
+    }
+};
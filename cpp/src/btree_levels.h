@@ -0,0 +1,291 @@
+#pragma once
+/// Cache-conscious B+tree level store.
+/// Nodes are sized to whole cache lines and keep keys (Price::raw) and values
+/// (Qty) inline in separate arrays. Unused key slots hold UINT64_MAX, so the
+/// in-node search is a fixed-length, branch-free count over the key array
+/// that the compiler vectorizes. Leaves form a doubly linked list, so the
+/// touch is the first (asks) or last (bids) entry of an end leaf.
+///
+/// Deletion is lazy: nodes may run underfull, and a node is unlinked only
+/// once it is empty. All leaves stay at the same depth, so the tree remains
+/// balanced. Nodes come from per-tree pools and are recycled on release, so
+/// steady-state updates never call `new`.
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include "types.h"
+#include "orderbook.h"
+#include "node_pool.h"
+
+template <Side S>
+class BTreeLevels {
+    static constexpr size_t   LEAF_CAP  = 16;   // 5 cache lines per leaf
+    static constexpr size_t   INNER_CAP = 15;   // 4 cache lines per inner node
+    static constexpr size_t   MAX_DEPTH = 16;
+    static constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+
+    struct alignas(64) Leaf {
+        uint64_t keys[LEAF_CAP];
+        uint64_t vals[LEAF_CAP];
+        Leaf*    prev  = nullptr;
+        Leaf*    next  = nullptr;
+        uint32_t count = 0;
+
+        Leaf() { std::fill(std::begin(keys), std::end(keys), EMPTY_KEY); }
+    };
+
+    struct alignas(64) Inner {
+        uint64_t keys[INNER_CAP];          // keys[i] = lowest key under children[i + 1]
+        void*    children[INNER_CAP + 1];  // Inner* above height 1, Leaf* at height 1
+        uint32_t count = 0;                // number of keys; count + 1 children
+
+        Inner() {
+            std::fill(std::begin(keys), std::end(keys), EMPTY_KEY);
+            std::fill(std::begin(children), std::end(children), nullptr);
+        }
+    };
+
+public:
+    BTreeLevels() { reset_root(); }
+    ~BTreeLevels() { free_subtree(root_, height_); }
+
+    BTreeLevels(const BTreeLevels&) = delete;
+    BTreeLevels& operator=(const BTreeLevels&) = delete;
+
+    void clear() {
+        free_subtree(root_, height_);
+        reset_root();
+    }
+
+    void set(Price price, Qty qty) {
+        const uint64_t key = price.raw;
+        Inner*   path[MAX_DEPTH];
+        uint32_t slots[MAX_DEPTH];
+        Leaf* leaf = descend(key, path, slots);
+
+        uint32_t pos = count_less(leaf->keys, key);
+        if (pos < leaf->count && leaf->keys[pos] == key) {
+            leaf->vals[pos] = qty.lots;
+            return;
+        }
+        ++size_;
+        if (leaf->count < LEAF_CAP) {
+            insert_at(leaf, pos, key, qty.lots);
+            return;
+        }
+
+        // Split: upper half moves to a new right sibling.
+        constexpr uint32_t half = LEAF_CAP / 2;
+        Leaf* right = leaves_.acquire();
+        for (uint32_t i = half; i < LEAF_CAP; ++i) {
+            right->keys[i - half] = leaf->keys[i];
+            right->vals[i - half] = leaf->vals[i];
+            leaf->keys[i] = EMPTY_KEY;
+        }
+        right->count = LEAF_CAP - half;
+        leaf->count = half;
+
+        right->prev = leaf;
+        right->next = leaf->next;
+        if (leaf->next) leaf->next->prev = right; else tail_ = right;
+        leaf->next = right;
+
+        if (pos <= half) {
+            insert_at(leaf, pos, key, qty.lots);
+        } else {
+            insert_at(right, pos - half, key, qty.lots);
+        }
+        insert_child(path, slots, right->keys[0], right);
+    }
+
+    void erase(Price price) {
+        const uint64_t key = price.raw;
+        Inner*   path[MAX_DEPTH];
+        uint32_t slots[MAX_DEPTH];
+        Leaf* leaf = descend(key, path, slots);
+
+        uint32_t pos = count_less(leaf->keys, key);
+        if (pos >= leaf->count || leaf->keys[pos] != key) return;
+        --size_;
+
+        for (uint32_t i = pos + 1; i < leaf->count; ++i) {
+            leaf->keys[i - 1] = leaf->keys[i];
+            leaf->vals[i - 1] = leaf->vals[i];
+        }
+        leaf->keys[--leaf->count] = EMPTY_KEY;
+        if (leaf->count > 0 || height_ == 0) return;
+
+        // Leaf emptied: unlink it and drop it from its parent.
+        if (leaf->prev) leaf->prev->next = leaf->next; else head_ = leaf->next;
+        if (leaf->next) leaf->next->prev = leaf->prev; else tail_ = leaf->prev;
+        leaves_.release(leaf);
+        remove_child(path, slots);
+    }
+
+    std::optional<Level> best() const {
+        if (size_ == 0) return std::nullopt;
+        if constexpr (S == Side::Bid) {
+            uint32_t i = tail_->count - 1;
+            return Level{Price(tail_->keys[i]), Qty(tail_->vals[i])};
+        } else {
+            return Level{Price(head_->keys[0]), Qty(head_->vals[0])};
+        }
+    }
+
+    size_t size() const { return size_; }
+
+private:
+    NodePool<Leaf>  leaves_;
+    NodePool<Inner> inners_;
+    void*  root_   = nullptr;
+    Leaf*  head_   = nullptr;
+    Leaf*  tail_   = nullptr;
+    size_t height_ = 0;        // number of inner levels above the leaves
+    size_t size_   = 0;
+
+    /// Number of keys < key. Fixed trip count over the whole array; the
+    /// EMPTY_KEY padding never compares less.
+    static uint32_t count_less(const uint64_t (&keys)[LEAF_CAP], uint64_t key) {
+        uint32_t n = 0;
+        for (size_t i = 0; i < LEAF_CAP; ++i) n += keys[i] < key;
+        return n;
+    }
+
+    /// Number of separators <= key, i.e. the child index to follow.
+    static uint32_t count_le(const uint64_t (&keys)[INNER_CAP], uint64_t key) {
+        uint32_t n = 0;
+        for (size_t i = 0; i < INNER_CAP; ++i) n += keys[i] <= key;
+        return n;
+    }
+
+    Leaf* descend(uint64_t key, Inner** path, uint32_t* slots) const {
+        void* node = root_;
+        for (size_t d = 0; d < height_; ++d) {
+            auto* inner = static_cast<Inner*>(node);
+            uint32_t c = count_le(inner->keys, key);
+            path[d] = inner;
+            slots[d] = c;
+            node = inner->children[c];
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+    static void insert_at(Leaf* leaf, uint32_t pos, uint64_t key, uint64_t val) {
+        for (uint32_t i = leaf->count; i > pos; --i) {
+            leaf->keys[i] = leaf->keys[i - 1];
+            leaf->vals[i] = leaf->vals[i - 1];
+        }
+        leaf->keys[pos] = key;
+        leaf->vals[pos] = val;
+        ++leaf->count;
+    }
+
+    /// Insert `child` (with lowest key `sep`) to the right of the node that
+    /// was split, splitting ancestors as needed and growing a new root.
+    void insert_child(Inner** path, uint32_t* slots, uint64_t sep, void* child) {
+        for (size_t depth = height_; depth > 0; --depth) {
+            Inner* inner = path[depth - 1];
+            uint32_t at = slots[depth - 1];
+
+            if (inner->count < INNER_CAP) {
+                for (uint32_t i = inner->count; i > at; --i) {
+                    inner->keys[i] = inner->keys[i - 1];
+                    inner->children[i + 1] = inner->children[i];
+                }
+                inner->keys[at] = sep;
+                inner->children[at + 1] = child;
+                ++inner->count;
+                return;
+            }
+
+            // Full: merge into scratch arrays, then split around the middle
+            // key, which is promoted to the parent.
+            uint64_t keys[INNER_CAP + 1];
+            void*    kids[INNER_CAP + 2];
+            for (uint32_t i = 0, j = 0; i < INNER_CAP + 1; ++i) {
+                keys[i] = (i == at) ? sep : inner->keys[j++];
+            }
+            for (uint32_t i = 0, j = 0; i < INNER_CAP + 2; ++i) {
+                kids[i] = (i == at + 1) ? child : inner->children[j++];
+            }
+
+            constexpr uint32_t mid = (INNER_CAP + 1) / 2;
+            Inner* right = inners_.acquire();
+            std::fill(std::begin(inner->keys), std::end(inner->keys), EMPTY_KEY);
+            std::fill(std::begin(inner->children), std::end(inner->children), nullptr);
+            for (uint32_t i = 0; i < mid; ++i) inner->keys[i] = keys[i];
+            for (uint32_t i = 0; i <= mid; ++i) inner->children[i] = kids[i];
+            inner->count = mid;
+            for (uint32_t i = mid + 1; i < INNER_CAP + 1; ++i) right->keys[i - mid - 1] = keys[i];
+            for (uint32_t i = mid + 1; i < INNER_CAP + 2; ++i) right->children[i - mid - 1] = kids[i];
+            right->count = INNER_CAP - mid;
+
+            sep = keys[mid];
+            child = right;
+        }
+
+        Inner* root = inners_.acquire();
+        root->keys[0] = sep;
+        root->children[0] = root_;
+        root->children[1] = child;
+        root->count = 1;
+        root_ = root;
+        ++height_;
+    }
+
+    /// Drop the child at `slots[depth - 1]` from each ancestor, freeing inner
+    /// nodes that lose their only child, then collapse single-child roots.
+    void remove_child(Inner** path, uint32_t* slots) {
+        size_t depth = height_;
+        for (; depth > 0; --depth) {
+            Inner* inner = path[depth - 1];
+            uint32_t at = slots[depth - 1];
+            if (inner->count == 0) {
+                inners_.release(inner);
+                continue;
+            }
+            // Removing child `at` also removes the separator on its left
+            // (or the first separator, for child 0).
+            for (uint32_t i = (at > 0 ? at : 1); i < inner->count; ++i) {
+                inner->keys[i - 1] = inner->keys[i];
+            }
+            for (uint32_t i = at + 1; i <= inner->count; ++i) {
+                inner->children[i - 1] = inner->children[i];
+            }
+            inner->children[inner->count] = nullptr;
+            inner->keys[--inner->count] = EMPTY_KEY;
+            break;
+        }
+
+        if (depth == 0) {
+            reset_root();
+            return;
+        }
+        while (height_ > 0 && static_cast<Inner*>(root_)->count == 0) {
+            auto* old = static_cast<Inner*>(root_);
+            root_ = old->children[0];
+            inners_.release(old);
+            --height_;
+        }
+    }
+
+    void free_subtree(void* node, size_t height) {
+        if (height == 0) {
+            leaves_.release(static_cast<Leaf*>(node));
+            return;
+        }
+        auto* inner = static_cast<Inner*>(node);
+        for (uint32_t i = 0; i <= inner->count; ++i) free_subtree(inner->children[i], height - 1);
+        inners_.release(inner);
+    }
+
+    void reset_root() {
+        Leaf* leaf = leaves_.acquire();
+        root_ = head_ = tail_ = leaf;
+        height_ = 0;
+        size_ = 0;
+    }
+};
+
+using BTreeOrderbook = BasicOrderbook<BTreeLevels>;
@@ -0,0 +1,353 @@
+#pragma once
+/// Versioned binary capture of a parsed feed.
+/// Raw layout (native little-endian, sections 64-byte aligned):
+///   CaptureHeader                      64 bytes
+///   Update[update_count]               fixed 40-byte records, feed order
+///   Level[level_count]                 snapshot level arena (bids then asks)
+/// Records are the in-memory Update/Level bytes, so loading is a bounds
+/// check and a copy out of the mmap; nothing is parsed. The header records
+/// the record sizes and the instrument scales the integers were built with,
+/// and the loader rejects files that do not match this build.
+///
+/// Delta-varint layout (version 2, for archival): after the header, the
+/// DeltaVarintCodec byte stream occupies [updates_offset, levels_offset),
+/// with snapshot levels inline; zero padding follows so the decoder can
+/// read whole words up to the end.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "types.h"
+#include "instrument.h"
+#include "varint_codec.h"
+
+enum class CaptureEncoding : uint16_t { Raw = 0, DeltaVarint = 1 };
+
+struct CaptureHeader {
+    static constexpr char     MAGIC[8] = {'O', 'B', 'C', 'A', 'P', 'T', 'R', '\0'};
+    static constexpr uint16_t VERSION  = 2;   // 1: raw only; 2 adds `encoding`
+
+    char     magic[8];
+    uint16_t version;
+    uint16_t update_size;     // sizeof(Update) at write time
+    uint16_t level_size;      // sizeof(Level) at write time
+    CaptureEncoding encoding; // zero (Raw) in version 1 files
+    uint32_t price_decimals;
+    uint32_t qty_decimals;
+    uint64_t tick_size;
+    uint64_t update_count;
+    uint64_t updates_offset;  // byte offset of the Update section (or encoded stream)
+    uint64_t level_count;
+    uint64_t levels_offset;   // byte offset of the Level section (or end of stream)
+
+    Instrument instrument() const { return Instrument{price_decimals, tick_size, qty_decimals}; }
+};
+
+static_assert(sizeof(CaptureHeader) == 64);
+static_assert(std::is_trivially_copyable_v<Level>);
+
+class CaptureWriter {
+public:
+    /// Write `feed` (parsed with `inst`) to `path`. Returns false on I/O error.
+    static bool write(const char* path, const UpdateLog& feed, const Instrument& inst,
+                      CaptureEncoding encoding = CaptureEncoding::Raw) {
+        FILE* f = fopen(path, "wb");
+        if (!f) {
+            perror("fopen");
+            return false;
+        }
+
+        CaptureHeader h{};
+        std::memcpy(h.magic, CaptureHeader::MAGIC, sizeof(h.magic));
+        h.version        = CaptureHeader::VERSION;
+        h.encoding       = encoding;
+        h.update_size    = sizeof(Update);
+        h.level_size     = sizeof(Level);
+        h.price_decimals = inst.price_decimals;
+        h.tick_size      = inst.tick_size;
+        h.qty_decimals   = inst.qty_decimals;
+        h.update_count   = feed.updates.size();
+        h.updates_offset = SECTION_ALIGN;
+        h.level_count    = feed.levels.size();
+
+        bool ok;
+        if (encoding == CaptureEncoding::DeltaVarint) {
+            std::vector<uint8_t> stream;
+            stream.reserve(feed.size() * 8);
+            DeltaVarintCodec::encode(feed, stream);
+            h.levels_offset = h.updates_offset + stream.size();
+            stream.resize(stream.size() + STREAM_PADDING, 0);
+            ok = put(f, &h, sizeof(h), 0) &&
+                 put(f, stream.data(), stream.size(), h.updates_offset);
+        } else {
+            h.levels_offset = align(h.updates_offset + h.update_count * sizeof(Update));
+            ok = put(f, &h, sizeof(h), 0) &&
+                 put(f, feed.updates.data(), h.update_count * sizeof(Update), h.updates_offset) &&
+                 put(f, feed.levels.data(), h.level_count * sizeof(Level), h.levels_offset);
+        }
+        if (fclose(f) != 0) ok = false;
+        if (!ok) perror("write");
+        return ok;
+    }
+
+    static constexpr uint64_t SECTION_ALIGN  = 64;
+    static constexpr size_t   STREAM_PADDING = 8;
+    static_assert(SECTION_ALIGN % alignof(Update) == 0 && SECTION_ALIGN % alignof(Level) == 0);
+
+    static uint64_t align(uint64_t off) {
+        return (off + SECTION_ALIGN - 1) & ~(SECTION_ALIGN - 1);
+    }
+
+private:
+    /// Zero-pad up to `offset`, then write `bytes`.
+    static bool put(FILE* f, const void* data, size_t bytes, uint64_t offset) {
+        static constexpr char zeros[SECTION_ALIGN] = {};
+        long pos = ftell(f);
+        if (pos < 0 || static_cast<uint64_t>(pos) > offset) return false;
+        if (fwrite(zeros, 1, offset - static_cast<uint64_t>(pos), f) != offset - static_cast<uint64_t>(pos)) {
+            return false;
+        }
+        return bytes == 0 || fwrite(data, 1, bytes, f) == bytes;
+    }
+};
+
+class CaptureReader {
+public:
+    /// mmap `path` and copy its sections into an UpdateLog. If `inst` is
+    /// given it receives the instrument the file was written with. Returns
+    /// an empty log (after printing why) if the file is not a valid capture.
+    static UpdateLog load(const char* path, Instrument* inst = nullptr) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            perror("open");
+            return {};
+        }
+        struct stat st;
+        fstat(fd, &st);
+        size_t size = static_cast<size_t>(st.st_size);
+        if (size < sizeof(CaptureHeader)) {
+            fprintf(stderr, "%s: too short for a capture header\n", path);
+            close(fd);
+            return {};
+        }
+
+        const char* data = static_cast<const char*>(
+            mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0));
+        close(fd);
+        if (data == MAP_FAILED) {
+            perror("mmap");
+            return {};
+        }
+        madvise(const_cast<char*>(data), size, MADV_SEQUENTIAL);
+
+        UpdateLog out;
+        CaptureHeader h;
+        std::memcpy(&h, data, sizeof(h));
+        const bool valid = validate(h, size, path);
+        if (valid && h.encoding == CaptureEncoding::DeltaVarint) {
+            const auto* base = reinterpret_cast<const uint8_t*>(data);
+            out.levels.reserve(h.level_count);
+            if (!DeltaVarintCodec::decode(base + h.updates_offset, base + h.levels_offset,
+                                          base + size, h.update_count, out) ||
+                out.levels.size() != h.level_count) {
+                fprintf(stderr, "%s: corrupt encoded stream\n", path);
+                out = UpdateLog{};
+            } else if (inst) {
+                *inst = h.instrument();
+            }
+        } else if (valid) {
+            out.updates.resize(h.update_count);
+            out.levels.resize(h.level_count);
+            std::memcpy(out.updates.data(), data + h.updates_offset, h.update_count * sizeof(Update));
+            std::memcpy(out.levels.data(), data + h.levels_offset, h.level_count * sizeof(Level));
+            if (!snapshots_in_bounds(out.updates, h.level_count)) {
+                fprintf(stderr, "%s: snapshot levels out of bounds\n", path);
+                out = UpdateLog{};
+            } else if (inst) {
+                *inst = h.instrument();
+            }
+        }
+
+        munmap(const_cast<char*>(data), size);
+        return out;
+    }
+
+    /// True if the first bytes of `path` carry the capture magic.
+    static bool is_capture(const char* path) {
+        CaptureHeader h;
+        return read_header(path, h);
+    }
+
+    /// Read the header of `path`; false if it has none or the magic is wrong.
+    static bool read_header(const char* path, CaptureHeader& h) {
+        FILE* f = fopen(path, "rb");
+        if (!f) return false;
+        bool ok = fread(&h, 1, sizeof(h), f) == sizeof(h) &&
+                  std::memcmp(h.magic, CaptureHeader::MAGIC, sizeof(h.magic)) == 0;
+        fclose(f);
+        return ok;
+    }
+
+    /// Every snapshot's level range lies inside the arena.
+    static bool snapshots_in_bounds(std::span<const Update> updates, uint64_t level_count) {
+        for (const Update& u : updates) {
+            if (u.type == Update::Type::Snapshot &&
+                uint64_t(u.levels_begin) + u.bid_count + u.ask_count > level_count) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Header sanity: magic, version, record layout, and section bounds and
+    /// placement (after the header; raw sections aligned and disjoint).
+    static bool validate(const CaptureHeader& h, size_t file_size, const char* path) {
+        const char* why = nullptr;
+        if (std::memcmp(h.magic, CaptureHeader::MAGIC, sizeof(h.magic)) != 0) {
+            why = "bad magic";
+        } else if (h.version == 0 || h.version > CaptureHeader::VERSION) {
+            why = "unsupported version";
+        } else if (h.update_size != sizeof(Update) || h.level_size != sizeof(Level)) {
+            why = "record layout differs from this build";
+        } else if (h.updates_offset < sizeof(CaptureHeader) || h.levels_offset < sizeof(CaptureHeader)) {
+            why = "section overlaps the header";
+        } else if (h.encoding == CaptureEncoding::DeltaVarint) {
+            // Every encoded update takes at least three bytes, every level two.
+            if (h.updates_offset > h.levels_offset || h.levels_offset > file_size ||
+                h.update_count > (h.levels_offset - h.updates_offset) / 3 ||
+                h.level_count > (h.levels_offset - h.updates_offset) / 2) {
+                why = "section out of bounds";
+            }
+        } else if (h.encoding != CaptureEncoding::Raw) {
+            why = "unknown encoding";
+        } else if (h.updates_offset % CaptureWriter::SECTION_ALIGN != 0 ||
+                   h.levels_offset % CaptureWriter::SECTION_ALIGN != 0) {
+            // The raw sections are used in place as Update / Level arrays.
+            why = "misaligned section";
+        } else if (h.updates_offset > file_size ||
+                   h.update_count > (file_size - h.updates_offset) / sizeof(Update) ||
+                   h.levels_offset > file_size ||
+                   h.level_count > (file_size - h.levels_offset) / sizeof(Level)) {
+            why = "section out of bounds";
+        } else if (h.updates_offset > h.levels_offset ||
+                   h.update_count > (h.levels_offset - h.updates_offset) / sizeof(Update)) {
+            why = "sections overlap";
+        }
+        if (why) fprintf(stderr, "%s: not a usable capture (%s)\n", path, why);
+        return why == nullptr;
+    }
+};
+
+/// Zero-copy view of a raw capture: the Update and Level sections are used
+/// in place as spans over a read-only mapping, so replay needs no private
+/// heap copy and a file larger than RAM streams through the page cache.
+/// The whole mapping is advised MADV_SEQUENTIAL (read ahead, drop behind);
+/// advise_ahead() issues MADV_WILLNEED for the next stretch of records as
+/// replay advances. `populate` maps with MAP_POPULATE instead, faulting the
+/// whole file in up front (for files that fit in memory, to keep page
+/// faults off the replay path). Encoded captures cannot be viewed in place.
+class CaptureView {
+public:
+    /// Records read ahead by advise_ahead() (~40 MiB of Update records).
+    static constexpr size_t READ_AHEAD_UPDATES = 1 << 20;
+
+    explicit CaptureView(const char* path, bool populate = false) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            perror("open");
+            return;
+        }
+        struct stat st;
+        fstat(fd, &st);
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ < sizeof(CaptureHeader)) {
+            fprintf(stderr, "%s: too short for a capture header\n", path);
+            close(fd);
+            return;
+        }
+
+        void* map = mmap(nullptr, size_, PROT_READ,
+                         MAP_PRIVATE | (populate ? MAP_POPULATE : 0), fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            perror("mmap");
+            return;
+        }
+        data_ = static_cast<const char*>(map);
+        madvise(map, size_, MADV_SEQUENTIAL);
+
+        std::memcpy(&header_, data_, sizeof(header_));
+        if (!CaptureReader::validate(header_, size_, path)) {
+            unmap();
+            return;
+        }
+        if (header_.encoding != CaptureEncoding::Raw) {
+            fprintf(stderr, "%s: encoded capture cannot be viewed in place\n", path);
+            unmap();
+            return;
+        }
+
+        updates_ = {reinterpret_cast<const Update*>(data_ + header_.updates_offset),
+                    header_.update_count};
+        levels_ = {reinterpret_cast<const Level*>(data_ + header_.levels_offset),
+                   header_.level_count};
+        advise_ahead(0);
+    }
+
+    ~CaptureView() { unmap(); }
+
+    CaptureView(const CaptureView&) = delete;
+    CaptureView& operator=(const CaptureView&) = delete;
+
+    bool ok() const { return data_ != nullptr; }
+
+    std::span<const Update> updates() const { return updates_; }
+    std::span<const Level> levels() const { return levels_; }
+    Instrument instrument() const { return header_.instrument(); }
+
+    /// Replay in chunks of READ_AHEAD_UPDATES: read-ahead is issued for the
+    /// next chunk and each chunk's snapshot ranges are bounds-checked (while
+    /// its records are being touched anyway) before fn(updates, levels).
+    /// Returns false, after printing why, if a snapshot is out of bounds.
+    template <typename Fn>
+    bool for_each_chunk(Fn&& fn) const {
+        for (size_t first = 0; first < updates_.size(); first += READ_AHEAD_UPDATES) {
+            advise_ahead(first + READ_AHEAD_UPDATES);
+            auto chunk = updates_.subspan(first, std::min(READ_AHEAD_UPDATES, updates_.size() - first));
+            if (!CaptureReader::snapshots_in_bounds(chunk, levels_.size())) {
+                fprintf(stderr, "capture: snapshot levels out of bounds\n");
+                return false;
+            }
+            fn(chunk, levels_);
+        }
+        return true;
+    }
+
+    /// Ask the kernel to start reading records [first, first + READ_AHEAD_UPDATES).
+    void advise_ahead(size_t first) const {
+        if (!ok() || first >= updates_.size()) return;
+        const size_t count = std::min(READ_AHEAD_UPDATES, updates_.size() - first);
+        const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        const auto begin = reinterpret_cast<uintptr_t>(updates_.data() + first) & ~(page - 1);
+        const auto end = reinterpret_cast<uintptr_t>(updates_.data() + first + count);
+        madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+    }
+
+private:
+    const char*             data_ = nullptr;
+    size_t                  size_ = 0;
+    CaptureHeader           header_{};
+    std::span<const Update> updates_;
+    std::span<const Level>  levels_;
+
+    void unmap() {
+        if (data_) munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        updates_ = {};
+        levels_ = {};
+    }
+};
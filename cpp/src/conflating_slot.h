@@ -0,0 +1,80 @@
+#pragma once
+/// Conflating single-slot channel (seqlock): the producer always overwrites
+/// the latest value and never waits; the consumer always reads the freshest
+/// one and skips whatever was overwritten in between. For a top-of-book
+/// consumer this bounds staleness to one publish, however bursty the feed,
+/// where a queue would hand over every stale BookNotification in order.
+///
+/// The sequence number is odd while a write is in progress. A reader copies
+/// the value out word by word and retries if the sequence changed under it.
+/// The payload is held as relaxed atomics, so a torn read is discarded
+/// rather than being a data race. T must be trivially copyable.
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "spsc_queue.h"
+
+template <typename T>
+class ConflatingSlot {
+    static_assert(std::is_trivially_copyable_v<T>, "ConflatingSlot needs a trivially copyable T");
+    static constexpr size_t WORDS = (sizeof(T) + 7) / 8;
+
+    // Written by the producer, read by the consumer.
+    alignas(CACHE_LINE) std::atomic<uint64_t> seq_{0};
+    std::atomic<uint64_t> data_[WORDS] = {};
+    // Consumer-only state on its own line.
+    alignas(CACHE_LINE) uint64_t last_seq_ = 0;
+    uint64_t conflated_ = 0;
+
+public:
+    /// Overwrite the slot with `value`. Never blocks.
+    void publish(const T& value) {
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &value, sizeof(T));
+        const uint64_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) data_[i].store(words[i], std::memory_order_relaxed);
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    /// Copy the latest value into `out` if one was published since the last
+    /// read. Returns false if there is nothing new (or a write is in
+    /// progress). Values overwritten unread are added to conflated().
+    bool try_read(T& out) {
+        uint64_t words[WORDS];
+        while (true) {
+            const uint64_t seq = seq_.load(std::memory_order_acquire);
+            if (seq == last_seq_ || (seq & 1)) return false;
+            for (size_t i = 0; i < WORDS; ++i) words[i] = data_[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) != seq) continue; // torn, retry
+
+            conflated_ += (seq - last_seq_) / 2 - 1;
+            last_seq_ = seq;
+            std::memcpy(&out, words, sizeof(T));
+            return true;
+        }
+    }
+
+    /// Blocking read — spins until a new value is available.
+    /// Returns false only if `closed` is set and nothing new is left.
+    bool read(T& out, const std::atomic<bool>& closed) {
+        while (!try_read(out)) {
+            if (closed.load(std::memory_order_acquire)) {
+                // Pick up a final value published before the flag was set
+                return try_read(out);
+            }
+            cpu_relax();
+        }
+        return true;
+    }
+
+    /// Values published so far.
+    uint64_t published() const { return seq_.load(std::memory_order_acquire) / 2; }
+
+    /// Values overwritten before the consumer read them (consumer side).
+    uint64_t conflated() const { return conflated_; }
+};
@@ -0,0 +1,201 @@
+#pragma once
+/// Pull-based CSV reader with a bounded memory footprint.
+/// The file is read() into one fixed window. Each next_batch() call parses
+/// every complete line in the window into a reused UpdateLog, then moves the
+/// trailing partial line to the front before the next read, so a line that
+/// straddles a chunk boundary is parsed once it is whole. Memory stays at
+/// one window plus one batch regardless of file length; the window only
+/// grows if a single line is longer than it.
+///
+/// Follow mode (follow()) tails a file that another process is appending
+/// to: at EOF the reader waits for growth instead of finishing, and only
+/// newline-terminated lines are parsed, so a line the writer is still in
+/// the middle of is picked up on a later pass. Growth is detected with
+/// inotify, or by polling the file size with exponential backoff.
+///
+/// Lines are cut at the last '\n' of the window, so records must not embed
+/// newlines inside quoted fields (true for this feed).
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "types.h"
+#include "instrument.h"
+#include "parser.h"
+#include "clock.h"
+
+class CsvStream {
+public:
+    static constexpr size_t DEFAULT_WINDOW = 1 << 20;
+
+    /// How follow mode notices that the file has grown.
+    enum class Wait : uint8_t { Inotify, Poll };
+
+    explicit CsvStream(const char* path,
+                       const Instrument& inst = Instrument::btc_usdt(),
+                       size_t window = DEFAULT_WINDOW)
+        : inst_(inst), buf_(window > 0 ? window : 1), path_(path) {
+        fd_ = open(path, O_RDONLY);
+        if (fd_ < 0) perror("open");
+    }
+
+    ~CsvStream() {
+        if (fd_ >= 0) close(fd_);
+        if (inotify_fd_ >= 0) close(inotify_fd_);
+    }
+
+    CsvStream(const CsvStream&) = delete;
+    CsvStream& operator=(const CsvStream&) = delete;
+
+    bool ok() const { return fd_ >= 0; }
+
+    /// Keep reading past EOF as the file grows. next_batch() then returns
+    /// false only once `stop` is set, or after `idle_timeout_ms` without
+    /// growth (0 = wait forever). Falls back to polling if inotify is
+    /// unavailable.
+    void follow(const std::atomic<bool>* stop, uint32_t idle_timeout_ms = 0,
+                Wait wait = Wait::Inotify) {
+        following_ = true;
+        stop_ = stop;
+        idle_timeout_ns_ = static_cast<uint64_t>(idle_timeout_ms) * 1'000'000;
+        if (wait == Wait::Inotify && inotify_fd_ < 0) {
+            inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (inotify_fd_ >= 0 && inotify_add_watch(inotify_fd_, path_.c_str(), IN_MODIFY) < 0) {
+                close(inotify_fd_);
+                inotify_fd_ = -1;
+            }
+        }
+    }
+
+    /// Replace `batch` with the next run of parsed updates. Snapshot levels
+    /// live in `batch.levels`, valid until the following call. Returns false
+    /// once the file is exhausted (or, when following, once stopped), or if
+    /// one batch holds more than UpdateLog::MAX_LEVELS snapshot levels.
+    bool next_batch(UpdateLog& batch) {
+        batch.clear();
+        while (batch.empty()) {
+            if (!fill()) {
+                if (!following_ || !wait_for_growth()) return false;
+                continue;
+            }
+
+            const char* data = buf_.data();
+            const char* end = data + filled_;
+            const char* cut = end;
+            if (!eof_ || following_) {
+                cut = static_cast<const char*>(memrchr(data, '\n', filled_));
+                if (!cut) {
+                    if (filled_ == buf_.size()) {
+                        // One line fills the window: grow and read more of it.
+                        buf_.resize(buf_.size() * 2);
+                    } else if (!wait_for_growth()) {
+                        return false; // following, line still incomplete
+                    }
+                    continue;
+                }
+                ++cut;
+            }
+
+            const char* pos = data;
+            if (!header_done_) {
+                const char* nl = static_cast<const char*>(memchr(pos, '\n', cut - pos));
+                pos = nl ? nl + 1 : cut;
+                header_done_ = true;
+            }
+
+            consumed_ = static_cast<size_t>(cut - data);
+            if (!CsvReader::parse_buffer(pos, static_cast<size_t>(cut - pos), inst_, batch)) {
+                fprintf(stderr, "%s: more than %zu snapshot levels in one batch\n",
+                        path_.c_str(), UpdateLog::MAX_LEVELS);
+                batch.clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Bytes currently reserved for the read window.
+    size_t window_bytes() const { return buf_.size(); }
+
+private:
+    Instrument        inst_;
+    std::vector<char> buf_;
+    std::string       path_;
+    int    fd_          = -1;
+    size_t filled_      = 0;     // valid bytes in buf_
+    size_t consumed_    = 0;     // leading bytes already parsed
+    size_t offset_      = 0;     // file bytes read so far
+    bool   eof_         = false;
+    bool   header_done_ = false;
+
+    bool                     following_       = false;
+    const std::atomic<bool>* stop_            = nullptr;
+    uint64_t                 idle_timeout_ns_ = 0;
+    int                      inotify_fd_      = -1;
+
+    /// Drop parsed bytes, then read until the window is full or EOF.
+    /// Returns false when there is nothing left to parse. When following,
+    /// EOF is re-tested on every call.
+    bool fill() {
+        if (fd_ < 0) return false;
+        if (consumed_ > 0) {
+            std::memmove(buf_.data(), buf_.data() + consumed_, filled_ - consumed_);
+            filled_ -= consumed_;
+            consumed_ = 0;
+        }
+        if (eof_ && !following_) return false;
+
+        eof_ = false;
+        size_t got = 0;
+        while (filled_ < buf_.size()) {
+            ssize_t n = read(fd_, buf_.data() + filled_, buf_.size() - filled_);
+            if (n < 0) {
+                perror("read");
+                eof_ = true;
+                break;
+            }
+            if (n == 0) {
+                eof_ = true;
+                break;
+            }
+            filled_ += static_cast<size_t>(n);
+            offset_ += static_cast<size_t>(n);
+            got += static_cast<size_t>(n);
+        }
+        // Following: a retained partial line alone is not new input.
+        return following_ ? got > 0 : filled_ > 0;
+    }
+
+    /// Block until the file is larger than what has been read. False if
+    /// stopped or idle for longer than the timeout.
+    bool wait_for_growth() {
+        const uint64_t start = Clock::now_ns();
+        uint64_t backoff_us = 50;
+        for (;;) {
+            if (stop_ && stop_->load(std::memory_order_relaxed)) return false;
+            struct stat st;
+            if (fstat(fd_, &st) == 0 && static_cast<size_t>(st.st_size) > offset_) return true;
+            if (idle_timeout_ns_ && Clock::now_ns() - start >= idle_timeout_ns_) return false;
+
+            if (inotify_fd_ >= 0) {
+                // Short timeout so `stop` and the idle limit are rechecked.
+                pollfd pfd{inotify_fd_, POLLIN, 0};
+                if (poll(&pfd, 1, 50) > 0) {
+                    char events[4096];
+                    while (read(inotify_fd_, events, sizeof(events)) > 0) {}
+                }
+            } else {
+                usleep(static_cast<useconds_t>(backoff_us));
+                backoff_us = std::min<uint64_t>(backoff_us * 2, 10'000);
+            }
+        }
+    }
+};
@@ -0,0 +1,142 @@
+#pragma once
+/// Allocation-free ASCII decimal -> fixed-point integer conversion.
+/// Digits are converted eight at a time with SWAR (SIMD within a register):
+/// a field is loaded into one 64-bit word behind '0' padding, the '.' is
+/// located and squeezed out with mask arithmetic, and three multiplies turn
+/// the eight ASCII digits into their value. "99999.99" becomes 9999999 in a
+/// single pass with no per-digit loop and no strtod. Fields of nine to
+/// sixteen bytes ("100009.36") are split at the '.' instead, and each side
+/// is converted as one chunk.
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include "instrument.h"
+
+class DecimalParser {
+public:
+    /// Plain decimal text ("3.1404") to an integer scaled by 10^decimals,
+    /// rounding half up on the first dropped digit.
+    static uint64_t parse_fixed(const char* start, const char* end, uint32_t decimals) {
+        const size_t len = static_cast<size_t>(end - start);
+        if (len <= 8) {
+            uint64_t chunk = load_right_aligned(start, len);
+            const unsigned dot = find_dot(chunk);
+            if (dot == 8) return swar8(chunk) * POW10[decimals];
+
+            const unsigned frac = 7 - dot;
+            if (frac <= decimals) {
+                // Shift the bytes before the '.' up one place over it, and
+                // refill the vacated most-significant byte with '0'.
+                const uint64_t before = (1ULL << (8 * dot)) - 1;
+                const uint64_t after  = ~before << 8;
+                chunk = ((chunk & before) << 8) | (chunk & after) | 0x30;
+                return swar8(chunk) * POW10[decimals - frac];
+            }
+        } else if (len <= 16) {
+            // Both words lie inside the field: the head holds the integer
+            // digits, the tail ends with the fraction. Masks replace
+            // whatever else either word holds with '0'.
+            uint64_t head, tail;
+            std::memcpy(&head, start, 8);
+            std::memcpy(&tail, end - 8, 8);
+            const unsigned dot = find_dot(head);
+            const size_t frac = len - dot - 1;
+            if (dot - 1 < 7 && frac <= 8 && frac <= decimals) {
+                const uint64_t whole = (head << (8 * (8 - dot))) | (ZEROS >> (8 * dot));
+                const uint64_t keep  = ~0ULL << (8 * (8 - frac));
+                const uint64_t part  = (tail & keep) | (ZEROS & ~keep);
+                return swar8(whole) * POW10[decimals] + swar8(part) * POW10[decimals - frac];
+            }
+        }
+        return parse_fixed_scalar(start, end, decimals);
+    }
+
+    /// Unsigned integer text (timestamps) via 8-digit SWAR chunks.
+    static uint64_t parse_u64(const char* start, const char* end) {
+        return parse_digits(start, static_cast<size_t>(end - start));
+    }
+
+    /// Reference byte-at-a-time conversion. Used for fields the SWAR path
+    /// does not cover (over sixteen bytes, an integer part over seven
+    /// digits, or more fraction digits than `decimals`), and by the
+    /// benchmark as a baseline.
+    static uint64_t parse_fixed_scalar(const char* start, const char* end, uint32_t decimals) {
+        uint64_t result = 0;
+        const char* p = start;
+        while (p < end && *p != '.') {
+            result = result * 10 + static_cast<uint64_t>(*p - '0');
+            ++p;
+        }
+        if (p < end) ++p; // skip '.'
+        uint32_t frac = 0;
+        for (; frac < decimals && p < end; ++frac, ++p) {
+            result = result * 10 + static_cast<uint64_t>(*p - '0');
+        }
+        result *= POW10[decimals - frac];
+        if (p < end && *p >= '5') ++result;
+        return result;
+    }
+
+private:
+    static constexpr uint64_t ZEROS = 0x3030303030303030ULL;
+    static constexpr uint64_t DOTS  = 0x2E2E2E2E2E2E2E2EULL;
+    static constexpr uint64_t LOWS  = 0x0101010101010101ULL;
+    static constexpr uint64_t HIGHS = 0x8080808080808080ULL;
+
+    /// n (<= 8) bytes placed at the end of a word whose leading bytes are
+    /// '0', so byte 0 is the most significant digit. Reads only [p, p + n)
+    /// and assembles the word in registers (no store-forwarding stall).
+    static uint64_t load_right_aligned(const char* p, size_t n) {
+        uint64_t v = 0;
+        if (n == 8) {
+            std::memcpy(&v, p, 8);
+            return v;
+        }
+        if (n == 0) return ZEROS;
+        size_t off = 0;
+        if (n & 4) {
+            uint32_t x;
+            std::memcpy(&x, p, 4);
+            v = x;
+            off = 4;
+        }
+        if (n & 2) {
+            uint16_t x;
+            std::memcpy(&x, p + off, 2);
+            v |= static_cast<uint64_t>(x) << (8 * off);
+            off += 2;
+        }
+        if (n & 1) {
+            v |= static_cast<uint64_t>(static_cast<unsigned char>(p[off])) << (8 * off);
+        }
+        return (v << (8 * (8 - n))) | (ZEROS >> (8 * n));
+    }
+
+    /// Byte index of the first '.', or 8 if there is none.
+    static unsigned find_dot(uint64_t chunk) {
+        const uint64_t x = chunk ^ DOTS;
+        const uint64_t hit = (x - LOWS) & ~x & HIGHS;
+        return hit ? static_cast<unsigned>(std::countr_zero(hit)) >> 3 : 8;
+    }
+
+    /// Value of eight ASCII digits, byte 0 most significant.
+    static uint64_t swar8(uint64_t chunk) {
+        chunk -= ZEROS;
+        chunk = (chunk * 10) + (chunk >> 8);
+        return (((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+                (((chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    }
+
+    static uint64_t parse_digits(const char* p, size_t n) {
+        if (n == 0) return 0;
+        const size_t head = ((n - 1) & 7) + 1;
+        uint64_t result = swar8(load_right_aligned(p, head));
+        for (p += head, n -= head; n > 0; p += 8, n -= 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, p, 8);
+            result = result * 100'000'000ULL + swar8(chunk);
+        }
+        return result;
+    }
+};
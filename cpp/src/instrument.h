@@ -0,0 +1,50 @@
+#pragma once
+/// Per-instrument fixed-point scales.
+/// The book and the channel only ever see integers; an Instrument says how
+/// to get between those integers and the decimal text on the wire. Prices
+/// are parsed to an integer at `price_decimals` and divided by the tick
+/// size, so Price::raw is a tick index and ladders stay dense. A wire price
+/// off the tick grid means the instrument is misconfigured or the feed is
+/// bad; the parser rejects it (see on_tick) instead of rounding it.
+
+#include <cstdint>
+#include "types.h"
+
+/// Powers of ten that fit in a uint64_t.
+inline constexpr uint64_t POW10[20] = {
+    1ULL, 10ULL, 100ULL, 1'000ULL, 10'000ULL, 100'000ULL, 1'000'000ULL,
+    10'000'000ULL, 100'000'000ULL, 1'000'000'000ULL, 10'000'000'000ULL,
+    100'000'000'000ULL, 1'000'000'000'000ULL, 10'000'000'000'000ULL,
+    100'000'000'000'000ULL, 1'000'000'000'000'000ULL,
+    10'000'000'000'000'000ULL, 100'000'000'000'000'000ULL,
+    1'000'000'000'000'000'000ULL, 10'000'000'000'000'000'000ULL,
+};
+
+struct Instrument {
+    uint32_t price_decimals;  // decimal places of prices on the wire
+    uint64_t tick_size;       // in units of 10^-price_decimals
+    uint32_t qty_decimals;    // Qty::lots = quantity * 10^qty_decimals
+
+    uint64_t qty_scale() const { return POW10[qty_decimals]; }
+
+    /// True if a price scaled by 10^price_decimals is a whole number of ticks.
+    bool on_tick(uint64_t scaled) const { return tick_size == 1 || scaled % tick_size == 0; }
+
+    /// Price scaled by 10^price_decimals -> nearest tick.
+    Price price_from_scaled(uint64_t scaled) const {
+        if (tick_size == 1) return Price(scaled);
+        return Price((scaled + tick_size / 2) / tick_size);
+    }
+
+    double price_to_f64(Price p) const {
+        return static_cast<double>(p.raw * tick_size) /
+               static_cast<double>(POW10[price_decimals]);
+    }
+
+    double qty_to_f64(Qty q) const {
+        return static_cast<double>(q.lots) / static_cast<double>(qty_scale());
+    }
+
+    /// Binance BTC/USDT: 0.01 USDT ticks, quantities to 1e-8 BTC.
+    static constexpr Instrument btc_usdt() { return Instrument{2, 1, 8}; }
+};
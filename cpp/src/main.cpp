@@ -1,95 +1,352 @@
 /// Ultra-low-latency orderbook system — main entry point (C++ version).
 /// Architecture mirrors the Rust version exactly:
-///   [mmap CSV reader] → parse_file() → vector<Update>
+///   [mmap CSV reader] → parse_file() → UpdateLog (updates + snapshot level arena)
+///     or, with --stream, [CsvStream] → bounded read() window → batches applied as parsed
+///     (--follow keeps tailing the file as it grows)
 ///        ↓
-///   [Engine thread] — applies to Orderbook, sends notification
-///        ↓ (lock-free SPSC queue, 4096 slots)
-///   [Strategy thread] — receives, logs best bid/ask, measures latency
+///   [Engine thread] — applies to Orderbook (--engine=map|pooled-map|vector|btree|ladder), sends notification
+///        ↓ (lock-free SPSC queue, 4096 slots; or --conflate: latest-value seqlock slot;
+///           or --strategies=N: broadcast ring, one cursor per consumer)
+///   [Strategy thread(s)] — receives, logs best bid/ask, measures latency
+///   [Recorder thread] — with --strategies=N, journals each notification after every strategy
 
 #include <cstdio>
+#include <cstdlib>
+#include <csignal>
 #include <thread>
 #include <atomic>
 #include <string>
 
 #include "types.h"
 #include "orderbook.h"
+#include "price_ladder.h"
+#include "vector_levels.h"
+#include "btree_levels.h"
+#include "pooled_map_levels.h"
 #include "parser.h"
+#include "csv_stream.h"
+#include "parallel_parser.h"
+#include "capture.h"
+#include "async_reader.h"
+#include "instrument.h"
 #include "spsc_queue.h"
+#include "conflating_slot.h"
+#include "broadcast_ring.h"
 #include "strategy.h"
 #include "clock.h"
 
 static constexpr size_t QUEUE_CAPACITY = 4096;
 
-int main(int argc, char* argv[]) {
-    const char* csv_path = (argc > 1) ? argv[1] : "btc_orderbook_updates.csv";
-
-    printf("=== Orderbook System (C++) ===\n");
-    printf("Loading CSV: %s\n", csv_path);
+using BroadcastChannel = BroadcastRing<BookNotification, QUEUE_CAPACITY>;
 
-    // Phase 1: Parse CSV (mmap, fast)
-    auto updates = CsvReader::parse_file(csv_path);
-    printf("Parsed %zu updates from CSV\n", updates.size());
+/// How the engine hands notifications to the strategy side.
+struct ChannelOptions {
+    bool     conflate   = false;  // latest-value ConflatingSlot instead of the queue
+    unsigned strategies = 1;      // > 1: BroadcastRing to N strategies plus a recorder
 
-    if (updates.empty()) {
-        fprintf(stderr, "No updates found. Exiting.\n");
-        return 1;
+    /// Check an explicit --strategies=N against what run() can honour.
+    /// Prints why and returns false if it cannot.
+    bool validate_fan_out() const {
+        if (strategies < 2) {
+            fprintf(stderr, "--strategies=N needs N >= 2 (omit it for one strategy)\n");
+            return false;
+        }
+        if (strategies + 1 > BroadcastChannel::MAX_CONSUMERS) {
+            fprintf(stderr, "At most %zu strategies\n", BroadcastChannel::MAX_CONSUMERS - 1);
+            return false;
+        }
+        if (conflate) {
+            fprintf(stderr, "--conflate cannot be combined with --strategies (every strategy sees every update)\n");
+            return false;
+        }
+        return true;
     }
+};
+
+/// Engine + strategy run for one level-store policy. `for_each_batch(fn)`
+/// calls fn(updates, levels) for each run of updates in feed order.
+/// With `conflate`, notifications go through a ConflatingSlot instead of
+/// the queue, and the strategy only sees the freshest top of book. With
+/// more than one strategy they go through a BroadcastRing read by every
+/// strategy, and by a recorder that runs behind all of them.
+template <typename Book, typename Source>
+static int run(Source&& for_each_batch, const Instrument& inst, const ChannelOptions& channel) {
+    const bool fan_out = channel.strategies > 1;
+    const bool conflate = channel.conflate;
 
-    // Phase 2: Set up queue and closed flag
-    auto queue = std::make_unique<SPSCQueue<BookNotification, QUEUE_CAPACITY>>();
+    // Phase 2: Set up channel and closed flag
+    std::unique_ptr<SPSCQueue<BookNotification, QUEUE_CAPACITY>> queue;
+    std::unique_ptr<ConflatingSlot<BookNotification>> latest;
+    std::unique_ptr<BroadcastChannel> ring;
+    if (fan_out) {
+        ring = std::make_unique<BroadcastChannel>();
+    } else if (conflate) {
+        latest = std::make_unique<ConflatingSlot<BookNotification>>();
+    } else {
+        queue = std::make_unique<SPSCQueue<BookNotification, QUEUE_CAPACITY>>();
+    }
     std::atomic<bool> closed{false};
 
-    // Phase 3: Spawn strategy consumer thread
-    StrategyStats stats;
+    // Phase 3: Spawn consumer threads. Fanning out, only strategy 0 logs.
+    const unsigned consumers = fan_out ? channel.strategies + 1 : 1;
+    std::vector<StrategyStats> stats(consumers);
+    std::vector<std::thread> threads;
+    std::vector<BookNotification> journal;
     auto* queue_ptr = queue.get();
-    std::thread strategy_thread([queue_ptr, &closed, &stats]() {
-        stats = run_strategy(*queue_ptr, closed, true);
-    });
+    auto* latest_ptr = latest.get();
+    auto* ring_ptr = ring.get();
+    if (fan_out) {
+        // Strategies read behind the engine; the recorder behind all of them.
+        std::vector<uint32_t> all_strategies;
+        for (uint32_t i = 0; i < channel.strategies; ++i) {
+            ring_ptr->add_consumer();
+            all_strategies.push_back(i);
+        }
+        ring_ptr->add_consumer(all_strategies);
+        journal.reserve(8192);
+    }
+    for (unsigned i = 0; i < consumers; ++i) {
+        threads.emplace_back([&, i]() {
+            if (!fan_out) {
+                stats[i] = latest_ptr ? run_strategy(*latest_ptr, closed, true, inst)
+                                      : run_strategy(*queue_ptr, closed, true, inst);
+            } else if (i < channel.strategies) {
+                stats[i] = run_strategy(*ring_ptr, i, closed, i == 0, inst);
+            } else {
+                stats[i] = run_recorder(*ring_ptr, i, closed, journal);
+            }
+        });
+    }
 
     // Phase 4: Engine — apply updates and send notifications
-    Orderbook book;
+    Book book;
+    size_t total = 0;
     uint64_t start = Clock::now_ns();
 
-    for (const auto& update : updates) {
-        uint64_t now = Clock::now_ns();
-        auto notif = book.apply(update, now);
-        queue_ptr->push(notif);
-    }
+    for_each_batch([&](std::span<const Update> updates, std::span<const Level> levels) {
+        for (const auto& update : updates) {
+            uint64_t now = Clock::now_ns();
+            book.advance(update, levels);
+            if (ring_ptr) {
+                ring_ptr->emplace(update.timestamp, now, book.best_bid(), book.best_ask(), book.seq());
+            } else if (latest_ptr) {
+                latest_ptr->publish(BookNotification{
+                    update.timestamp, now, book.best_bid(), book.best_ask(), book.seq()});
+            } else {
+                queue_ptr->emplace(update.timestamp, now, book.best_bid(), book.best_ask(), book.seq());
+            }
+        }
+        total += updates.size();
+    });
 
     uint64_t end_ns = Clock::now_ns();
     uint64_t elapsed_ns = end_ns - start;
 
     // Signal done and wait
     closed.store(true, std::memory_order_release);
-    strategy_thread.join();
+    for (auto& t : threads) t.join();
 
     // Phase 5: Print summary
     double elapsed_us = elapsed_ns / 1000.0;
     double elapsed_ms = elapsed_ns / 1'000'000.0;
     double throughput = (elapsed_ns > 0)
-        ? (updates.size() / static_cast<double>(elapsed_ns)) * 1'000'000'000.0
+        ? (total / static_cast<double>(elapsed_ns)) * 1'000'000'000.0
         : 0.0;
 
     printf("\n=== Engine Summary ===\n");
-    printf("Total updates:     %zu\n", updates.size());
+    printf("Total updates:     %zu\n", total);
     printf("Engine time:       %.2f ms (%.2f us)\n", elapsed_ms, elapsed_us);
     printf("Throughput:        %.0f updates/sec\n", throughput);
     printf("Final book depth:  %zu bids, %zu asks\n", book.bid_depth(), book.ask_depth());
     if (auto bb = book.best_bid()) {
-        printf("Final best bid:    %.2f @ %.4f\n", bb->price.to_f64(), bb->qty.value);
+        printf("Final best bid:    %.*f @ %.4f\n", inst.price_decimals,
+            inst.price_to_f64(bb->price), inst.qty_to_f64(bb->qty));
     }
     if (auto ba = book.best_ask()) {
-        printf("Final best ask:    %.2f @ %.4f\n", ba->price.to_f64(), ba->qty.value);
+        printf("Final best ask:    %.*f @ %.4f\n", inst.price_decimals,
+            inst.price_to_f64(ba->price), inst.qty_to_f64(ba->qty));
+    }
+
+    if (fan_out) {
+        printf("\n=== Per-Consumer Latency (engine->consumer, broadcast ring) ===\n");
+        printf("%-12s %9s %12s %12s %12s %12s\n", "consumer", "received", "min", "median", "p99", "max");
+        for (unsigned i = 0; i < consumers; ++i) {
+            char name[16];
+            if (i < channel.strategies) {
+                snprintf(name, sizeof(name), "strategy %u", i);
+            } else {
+                snprintf(name, sizeof(name), "recorder");
+            }
+            printf("%-12s %9lu %9lu ns %9lu ns %9lu ns %9lu ns\n", name, stats[i].count,
+                   stats[i].min_latency_ns, stats[i].median(), stats[i].percentile(99.0),
+                   stats[i].max_latency_ns);
+        }
+        printf("Recorded:          %zu notifications\n", journal.size());
+        return 0;
     }
 
+    const StrategyStats& s = stats[0];
     printf("\n=== Strategy Latency (engine->strategy) ===\n");
-    printf("Updates received:  %lu\n", stats.count);
-    printf("Min latency:       %lu ns\n", stats.min_latency_ns);
-    printf("Max latency:       %lu ns\n", stats.max_latency_ns);
-    printf("Avg latency:       %lu ns\n", stats.avg_ns());
-    printf("Median latency:    %lu ns\n", stats.median());
-    printf("P99 latency:       %lu ns\n", stats.percentile(99.0));
-    printf("P99.9 latency:     %lu ns\n", stats.percentile(99.9));
+    printf("Updates received:  %lu\n", s.count);
+    if (conflate) printf("Conflated:         %lu\n", s.conflated);
+    printf("Min latency:       %lu ns\n", s.min_latency_ns);
+    printf("Max latency:       %lu ns\n", s.max_latency_ns);
+    printf("Avg latency:       %lu ns\n", s.avg_ns());
+    printf("Median latency:    %lu ns\n", s.median());
+    printf("P99 latency:       %lu ns\n", s.percentile(99.0));
+    printf("P99.9 latency:     %lu ns\n", s.percentile(99.9));
 
     return 0;
 }
+
+/// True if `engine` names a level-store policy run_engine() knows;
+/// reports it otherwise. Checked while parsing options, before any input
+/// is read.
+static bool check_engine(const std::string& engine) {
+    for (const char* name : {"map", "pooled-map", "vector", "btree", "ladder"}) {
+        if (engine == name) return true;
+    }
+    fprintf(stderr, "Unknown engine '%s' (expected map|pooled-map|vector|btree|ladder)\n", engine.c_str());
+    return false;
+}
+
+/// Pick the level-store policy named by --engine and run it on `source`.
+template <typename Source>
+static int run_engine(const std::string& engine, Source&& source, const Instrument& inst,
+                      const ChannelOptions& channel) {
+    if (engine == "map") return run<Orderbook>(source, inst, channel);
+    if (engine == "pooled-map") return run<PooledOrderbook>(source, inst, channel);
+    if (engine == "vector") return run<VectorOrderbook>(source, inst, channel);
+    if (engine == "btree") return run<BTreeOrderbook>(source, inst, channel);
+    if (engine == "ladder") return run<LadderOrderbook>(source, inst, channel);
+    return 1; // rejected by check_engine() while parsing options
+}
+
+/// Set by SIGINT/SIGTERM to end --follow.
+static std::atomic<bool> g_stop{false};
+
+static void on_stop_signal(int) { g_stop.store(true, std::memory_order_relaxed); }
+
+int main(int argc, char* argv[]) {
+    const char* csv_path = "btc_orderbook_updates.csv";
+    std::string engine = "map";
+    bool stream = false;
+    bool populate = false;
+    bool async = false;
+    bool follow = false;
+    ChannelOptions channel;
+    uint32_t follow_idle_ms = 0;
+    unsigned parse_threads = 1;
+    bool strategies_set = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--engine=", 0) == 0) {
+            engine = arg.substr(9);
+            if (!check_engine(engine)) return 1;
+        } else if (arg.rfind("--parse-threads=", 0) == 0) {
+            parse_threads = static_cast<unsigned>(strtoul(arg.c_str() + 16, nullptr, 10));
+        } else if (arg == "--stream") {
+            stream = true;
+        } else if (arg == "--populate") {
+            populate = true;
+        } else if (arg == "--async") {
+            async = true;
+        } else if (arg == "--conflate") {
+            channel.conflate = true;
+        } else if (arg.rfind("--strategies=", 0) == 0) {
+            const char* value = arg.c_str() + 13;
+            char* end = nullptr;
+            const unsigned long n = strtoul(value, &end, 10);
+            if (end == value || *end != '\0' || n > UINT32_MAX) {
+                fprintf(stderr, "Invalid --strategies value '%s' (expected a number)\n", value);
+                return 1;
+            }
+            channel.strategies = static_cast<unsigned>(n);
+            strategies_set = true;
+        } else if (arg == "--follow") {
+            follow = true;
+        } else if (arg.rfind("--follow-idle-ms=", 0) == 0) {
+            follow = true;
+            follow_idle_ms = static_cast<uint32_t>(strtoul(arg.c_str() + 17, nullptr, 10));
+        } else {
+            csv_path = argv[i];
+        }
+    }
+    if (strategies_set && !channel.validate_fan_out()) return 1;
+
+    // A capture (raw or encoded) is never parsed, so the CSV reader
+    // options have nothing to act on.
+    CaptureHeader header;
+    const bool capture = CaptureReader::read_header(csv_path, header);
+    if (capture && (stream || follow || async || parse_threads > 1)) {
+        fprintf(stderr, "%s is a capture: --stream, --follow, --async and --parse-threads "
+                        "apply only to CSV input\n", csv_path);
+        return 1;
+    }
+
+    printf("=== Orderbook System (C++) ===\n");
+    Instrument inst = Instrument::btc_usdt();
+
+    if (stream || follow) {
+        // Parse and apply interleaved: the engine starts on the first batch.
+        printf("%s CSV: %s (%zu KiB window)\n", follow ? "Following" : "Streaming",
+               csv_path, CsvStream::DEFAULT_WINDOW / 1024);
+        CsvStream reader(csv_path, inst);
+        if (!reader.ok()) return 1;
+        if (follow) {
+            // Tail the file as it grows until Ctrl-C (or the idle timeout).
+            signal(SIGINT, on_stop_signal);
+            signal(SIGTERM, on_stop_signal);
+            reader.follow(&g_stop, follow_idle_ms);
+        }
+        UpdateLog batch;
+        return run_engine(engine, [&](auto&& apply) {
+            while (reader.next_batch(batch)) apply(batch.updates, batch.levels);
+        }, inst, channel);
+    }
+
+    // A raw capture is replayed in place from the mapping: no parse, no copy.
+    if (capture && header.encoding == CaptureEncoding::Raw) {
+        printf("Mapping capture: %s%s\n", csv_path, populate ? " (MAP_POPULATE)" : "");
+        CaptureView view(csv_path, populate);
+        if (!view.ok()) return 1;
+        printf("Mapped %zu updates from capture\n", view.updates().size());
+        inst = view.instrument();
+        bool replayed = true;
+        const int rc = run_engine(engine, [&](auto&& apply) {
+            replayed = view.for_each_chunk(apply);
+        }, inst, channel);
+        if (!replayed) {
+            // The summary above covers only the updates before the bad chunk.
+            fprintf(stderr, "Corrupt capture %s: replay stopped early. Exiting.\n", csv_path);
+            return 1;
+        }
+        return rc;
+    }
+
+    // Phase 1: Decode an encoded capture (no parsing), or parse CSV (mmap,
+    // fast; optionally split across threads or fed by read-ahead I/O)
+    UpdateLog feed;
+    if (capture) {
+        printf("Loading capture: %s\n", csv_path);
+        feed = CaptureReader::load(csv_path, &inst);
+        printf("Loaded %zu updates from capture\n", feed.size());
+    } else {
+        printf("Loading CSV: %s\n", csv_path);
+        if (async) {
+            feed = AsyncCsvReader::parse_file(csv_path, inst);
+        } else if (parse_threads > 1) {
+            feed = ParallelCsvReader::parse_file(csv_path, parse_threads, inst);
+        } else {
+            feed = CsvReader::parse_file(csv_path, inst);
+        }
+        printf("Parsed %zu updates from CSV\n", feed.size());
+    }
+
+    if (feed.empty()) {
+        fprintf(stderr, "No updates found. Exiting.\n");
+        return 1;
+    }
+
+    return run_engine(engine, [&](auto&& apply) { apply(feed.updates, feed.levels); }, inst, channel);
+}
@@ -0,0 +1,57 @@
+#pragma once
+/// Fixed-size node pool with an intrusive free list.
+/// Nodes are carved from cache-line-aligned chunks and recycled on release,
+/// so once the pool has grown to the working-set size, acquire/release never
+/// touch the heap. Memory is returned only when the pool is destroyed.
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+template <typename Node, size_t NodesPerChunk = 64>
+class NodePool {
+public:
+    NodePool() = default;
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    ~NodePool() {
+        for (void* chunk : chunks_) {
+            ::operator delete(chunk, std::align_val_t(alignof(Node)));
+        }
+    }
+
+    /// Default-construct a node in a recycled (or freshly carved) slot.
+    Node* acquire() {
+        if (!free_) grow();
+        FreeSlot* slot = free_;
+        free_ = slot->next;
+        return new (slot) Node();
+    }
+
+    void release(Node* node) {
+        node->~Node();
+        auto* slot = reinterpret_cast<FreeSlot*>(node);
+        slot->next = free_;
+        free_ = slot;
+    }
+
+private:
+    struct FreeSlot { FreeSlot* next; };
+    static_assert(sizeof(Node) >= sizeof(FreeSlot), "node too small for free list");
+
+    FreeSlot* free_ = nullptr;
+    std::vector<void*> chunks_;
+
+    void grow() {
+        void* chunk = ::operator new(sizeof(Node) * NodesPerChunk,
+                                     std::align_val_t(alignof(Node)));
+        chunks_.push_back(chunk);
+        auto* bytes = static_cast<unsigned char*>(chunk);
+        for (size_t i = NodesPerChunk; i-- > 0;) {
+            auto* slot = reinterpret_cast<FreeSlot*>(bytes + i * sizeof(Node));
+            slot->next = free_;
+            free_ = slot;
+        }
+    }
+};
@@ -0,0 +1,89 @@
+#pragma once
+/// Two-level occupancy bitmap for dense tick-indexed books.
+/// One bit per slot in 64-bit words, plus a summary layer with one bit per
+/// non-empty word. Finding the next occupied slot in either direction is a
+/// masked lzcnt/tzcnt on the current word and, at most, one on the summary —
+/// a 4096-slot window has a single summary word.
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+class OccupancyBitmap {
+public:
+    static constexpr size_t NONE = ~size_t(0);
+
+    explicit OccupancyBitmap(size_t bits = 0) { resize(bits); }
+
+    /// Resize to `bits` slots and clear every bit.
+    void resize(size_t bits) {
+        words_.assign((bits + 63) / 64, 0);
+        summary_.assign((words_.size() + 63) / 64, 0);
+    }
+
+    void clear() {
+        std::fill(words_.begin(), words_.end(), 0);
+        std::fill(summary_.begin(), summary_.end(), 0);
+    }
+
+    bool test(size_t i) const { return (words_[i >> 6] >> (i & 63)) & 1; }
+
+    void set(size_t i) {
+        size_t w = i >> 6;
+        words_[w] |= 1ULL << (i & 63);
+        summary_[w >> 6] |= 1ULL << (w & 63);
+    }
+
+    void reset(size_t i) {
+        size_t w = i >> 6;
+        words_[w] &= ~(1ULL << (i & 63));
+        if (words_[w] == 0) summary_[w >> 6] &= ~(1ULL << (w & 63));
+    }
+
+    /// Highest set slot <= i, or NONE.
+    size_t find_prev(size_t i) const {
+        size_t w = i >> 6;
+        uint64_t m = words_[w] & (~0ULL >> (63 - (i & 63)));
+        if (m) return (w << 6) + 63 - std::countl_zero(m);
+
+        size_t sw = w >> 6;
+        uint64_t sm = summary_[sw] & ((1ULL << (w & 63)) - 1);
+        while (!sm) {
+            if (sw == 0) return NONE;
+            sm = summary_[--sw];
+        }
+        w = (sw << 6) + 63 - std::countl_zero(sm);
+        return (w << 6) + 63 - std::countl_zero(words_[w]);
+    }
+
+    /// Lowest set slot >= i, or NONE.
+    size_t find_next(size_t i) const {
+        size_t w = i >> 6;
+        uint64_t m = words_[w] & (~0ULL << (i & 63));
+        if (m) return (w << 6) + std::countr_zero(m);
+
+        size_t sw = w >> 6;
+        uint64_t sm = ((w & 63) == 63) ? 0 : summary_[sw] & (~0ULL << ((w & 63) + 1));
+        while (!sm) {
+            if (++sw == summary_.size()) return NONE;
+            sm = summary_[sw];
+        }
+        w = (sw << 6) + std::countr_zero(sm);
+        return (w << 6) + std::countr_zero(words_[w]);
+    }
+
+    /// Call f(i) for every set slot in ascending order.
+    template <typename F>
+    void for_each(F&& f) const {
+        for (size_t w = 0; w < words_.size(); ++w) {
+            for (uint64_t m = words_[w]; m; m &= m - 1) {
+                f((w << 6) + std::countr_zero(m));
+            }
+        }
+    }
+
+private:
+    std::vector<uint64_t> words_;
+    std::vector<uint64_t> summary_;
+};
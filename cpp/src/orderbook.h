@@ -1,21 +1,53 @@
 #pragma once
 /// Ultra-low-latency L2 orderbook engine (C++ version).
-/// Uses std::map (red-black tree, equivalent to Rust BTreeMap for this purpose)
-/// with cached best bid/ask for O(1) lookups.
+/// BasicOrderbook is templated over a level-storage policy chosen at compile
+/// time, so the hot path inlines fully whichever container backs the book.
+/// The default `Orderbook` uses std::map (red-black tree, equivalent to Rust
+/// BTreeMap for this purpose) with cached best bid/ask for O(1) lookups.
+///
+/// A level store is a class template over Side providing:
+///   void clear();
+///   void set(Price, Qty);                 // insert or overwrite, qty != 0
+///   void erase(Price);                    // no-op if absent
+///   std::optional<Level> best() const;    // touch for that side
+///   size_t size() const;
 
 #include <map>
 #include "types.h"
 
-class Orderbook {
+/// std::map level store. Both sides sort ascending; the best bid is the
+/// last entry and the best ask the first.
+template <Side S>
+class MapLevels {
 public:
-    /// Apply an update and return a notification.
-    BookNotification apply(const Update& update, uint64_t send_ns) {
-        if (update.type == Update::Type::Snapshot) {
-            apply_snapshot(update.bids, update.asks);
+    void clear() { levels_.clear(); }
+    void set(Price price, Qty qty) { levels_[price.raw] = qty.lots; }
+    void erase(Price price) { levels_.erase(price.raw); }
+    size_t size() const { return levels_.size(); }
+
+    std::optional<Level> best() const {
+        if (levels_.empty()) return std::nullopt;
+        if constexpr (S == Side::Bid) {
+            auto it = levels_.rbegin();
+            return Level{Price(it->first), Qty(it->second)};
         } else {
-            apply_incremental(update.side, update.level);
+            auto it = levels_.begin();
+            return Level{Price(it->first), Qty(it->second)};
         }
-        ++seq_;
+    }
+
+private:
+    std::map<uint64_t, uint64_t> levels_;
+};
+
+template <template <Side> class Levels>
+class BasicOrderbook {
+public:
+    /// Apply an update and return a notification. `arena` holds the levels
+    /// that snapshot updates reference.
+    BookNotification apply(const Update& update, std::span<const Level> arena,
+                           uint64_t send_ns) {
+        advance(update, arena);
         return BookNotification{
             update.timestamp,
             send_ns,
@@ -25,57 +57,62 @@ public:
         };
     }
 
+    /// Apply an update without building a notification; the caller reads
+    /// best_bid(), best_ask() and seq() (e.g. to emplace one into a queue).
+    void advance(const Update& update, std::span<const Level> arena) {
+        if (update.type == Update::Type::Snapshot) {
+            apply_snapshot(update.bids(arena), update.asks(arena));
+        } else {
+            apply_incremental(update.side, update.level);
+        }
+        ++seq_;
+    }
+
     std::optional<Level> best_bid() const { return cached_best_bid_; }
     std::optional<Level> best_ask() const { return cached_best_ask_; }
+    /// Number of updates applied so far (the seq of the last notification).
+    uint64_t seq() const { return seq_; }
     size_t bid_depth() const { return bids_.size(); }
     size_t ask_depth() const { return asks_.size(); }
 
-private:
-    // Bids: sorted ascending, best bid = rbegin (highest price)
-    std::map<uint64_t, double> bids_;
-    // Asks: sorted ascending, best ask = begin (lowest price)
-    std::map<uint64_t, double> asks_;
-
-    std::optional<Level> cached_best_bid_;
-    std::optional<Level> cached_best_ask_;
-    uint64_t seq_ = 0;
-
-    void apply_snapshot(const std::vector<Level>& bids, const std::vector<Level>& asks) {
+    /// Lower-level entry points for replays that drive the book without
+    /// building Update records or notifications (e.g. columnar replay).
+    void apply_snapshot(std::span<const Level> bids, std::span<const Level> asks) {
         bids_.clear();
         asks_.clear();
         for (const auto& l : bids) {
             if (!l.qty.is_zero())
-                bids_[l.price.raw] = l.qty.value;
+                bids_.set(l.price, l.qty);
         }
         for (const auto& l : asks) {
             if (!l.qty.is_zero())
-                asks_[l.price.raw] = l.qty.value;
+                asks_.set(l.price, l.qty);
         }
-        refresh_best_bid();
-        refresh_best_ask();
+        cached_best_bid_ = bids_.best();
+        cached_best_ask_ = asks_.best();
     }
 
     void apply_incremental(Side side, Level level) {
         if (side == Side::Bid) {
             if (level.qty.is_zero()) {
-                bids_.erase(level.price.raw);
+                bids_.erase(level.price);
                 if (cached_best_bid_ && cached_best_bid_->price == level.price) {
-                    refresh_best_bid();
+                    cached_best_bid_ = bids_.best();
                 }
             } else {
-                bids_[level.price.raw] = level.qty.value;
+                bids_.set(level.price, level.qty);
                 if (!cached_best_bid_ || level.price >= cached_best_bid_->price) {
                     cached_best_bid_ = level;
                 }
             }
         } else {
             if (level.qty.is_zero()) {
-                asks_.erase(level.price.raw);
+                asks_.erase(level.price);
                 if (cached_best_ask_ && cached_best_ask_->price == level.price) {
-                    refresh_best_ask();
+                    cached_best_ask_ = asks_.best();
                 }
             } else {
-                asks_[level.price.raw] = level.qty.value;
+                asks_.set(level.price, level.qty);
                 if (!cached_best_ask_ || level.price <= cached_best_ask_->price) {
                     cached_best_ask_ = level;
                 }
@@ -83,21 +120,13 @@ private:
         }
     }
 
-    void refresh_best_bid() {
-        if (bids_.empty()) {
-            cached_best_bid_ = std::nullopt;
-        } else {
-            auto it = bids_.rbegin();
-            cached_best_bid_ = Level{Price(it->first), Qty(it->second)};
-        }
-    }
+private:
+    Levels<Side::Bid> bids_;
+    Levels<Side::Ask> asks_;
 
-    void refresh_best_ask() {
-        if (asks_.empty()) {
-            cached_best_ask_ = std::nullopt;
-        } else {
-            auto it = asks_.begin();
-            cached_best_ask_ = Level{Price(it->first), Qty(it->second)};
-        }
-    }
+    std::optional<Level> cached_best_bid_;
+    std::optional<Level> cached_best_ask_;
+    uint64_t seq_ = 0;
 };
+
+using Orderbook = BasicOrderbook<MapLevels>;
@@ -0,0 +1,126 @@
+#pragma once
+/// Multi-threaded CSV parse with an ordered merge.
+/// The body is cut into N byte ranges that are parsed on worker threads and
+/// concatenated in order, so the result is byte-identical to the serial
+/// CsvReader. Each cut moves forward to just past the next newline. The
+/// structural index ends any open quote at a raw newline, so a cut there
+/// never splits a field, even after a stray quote.
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "types.h"
+#include "instrument.h"
+#include "parser.h"
+
+class ParallelCsvReader {
+public:
+    /// Ranges smaller than this are not worth a thread.
+    static constexpr size_t MIN_RANGE_BYTES = 256 * 1024;
+
+    /// mmap `path` and parse it with up to `threads` workers.
+    static UpdateLog parse_file(const char* path, unsigned threads,
+                                const Instrument& inst = Instrument::btc_usdt()) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            perror("open");
+            return {};
+        }
+        struct stat st;
+        fstat(fd, &st);
+        size_t size = static_cast<size_t>(st.st_size);
+
+        const char* data = static_cast<const char*>(
+            mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0));
+        if (data == MAP_FAILED) {
+            perror("mmap");
+            close(fd);
+            return {};
+        }
+        close(fd);
+
+        const char* nl = static_cast<const char*>(memchr(data, '\n', size));
+        const char* body = nl ? nl + 1 : data + size;
+        UpdateLog out = parse_buffer(body, static_cast<size_t>(data + size - body), threads, inst);
+
+        munmap(const_cast<char*>(data), size);
+        return out;
+    }
+
+    /// Parse header-less CSV text in [data, data + size) on up to `threads`
+    /// workers. Same result as CsvReader::parse_buffer on the whole range.
+    static UpdateLog parse_buffer(const char* data, size_t size, unsigned threads,
+                                  const Instrument& inst = Instrument::btc_usdt()) {
+        const size_t n = std::clamp<size_t>(size / MIN_RANGE_BYTES, 1, std::max(threads, 1u));
+        std::vector<const char*> cuts = split_points(data, size, n);
+
+        std::vector<UpdateLog> parts(n);
+        for_each_range(n, [&](size_t i) {
+            parts[i].reserve(static_cast<size_t>(cuts[i + 1] - cuts[i]) / 64);
+            CsvReader::parse_buffer(cuts[i], static_cast<size_t>(cuts[i + 1] - cuts[i]), inst, parts[i]);
+        });
+        return merge(parts);
+    }
+
+private:
+    /// Run fn(0..n-1), one call per thread (the last on the calling thread).
+    template <typename Fn>
+    static void for_each_range(size_t n, Fn&& fn) {
+        std::vector<std::thread> workers;
+        workers.reserve(n - 1);
+        for (size_t i = 0; i + 1 < n; ++i) workers.emplace_back(fn, i);
+        fn(n - 1);
+        for (auto& w : workers) w.join();
+    }
+
+    /// n + 1 line-aligned boundaries: data, ..., data + size.
+    static std::vector<const char*> split_points(const char* data, size_t size, size_t n) {
+        const char* end = data + size;
+        std::vector<const char*> cuts(n + 1);
+        cuts[0] = data;
+        cuts[n] = end;
+        for (size_t i = 1; i < n; ++i) {
+            // Advance each start to just past the next newline.
+            const char* start = std::max(data + size * i / n, cuts[i - 1]);
+            const char* nl = static_cast<const char*>(
+                memchr(start, '\n', static_cast<size_t>(end - start)));
+            cuts[i] = nl ? nl + 1 : end;
+        }
+        return cuts;
+    }
+
+    /// Concatenate per-range logs in order, rebasing snapshot arena offsets.
+    /// Returns an empty log if the merged arena would exceed
+    /// UpdateLog::MAX_LEVELS (the rebased offsets would wrap).
+    static UpdateLog merge(std::vector<UpdateLog>& parts) {
+        size_t updates = 0, levels = 0;
+        for (const auto& p : parts) {
+            updates += p.updates.size();
+            levels += p.levels.size();
+        }
+        if (levels > UpdateLog::MAX_LEVELS) {
+            fprintf(stderr, "parse: more than %zu snapshot levels\n", UpdateLog::MAX_LEVELS);
+            return {};
+        }
+        if (parts.size() == 1) return std::move(parts[0]);
+        UpdateLog out;
+        out.updates.reserve(updates);
+        out.levels.reserve(levels);
+        for (const auto& p : parts) {
+            const auto base = static_cast<uint32_t>(out.levels.size());
+            const size_t first = out.updates.size();
+            out.updates.insert(out.updates.end(), p.updates.begin(), p.updates.end());
+            for (size_t i = first; i < out.updates.size(); ++i) {
+                Update& u = out.updates[i];
+                if (u.type == Update::Type::Snapshot) u.levels_begin += base;
+            }
+            out.levels.insert(out.levels.end(), p.levels.begin(), p.levels.end());
+        }
+        return out;
+    }
+};
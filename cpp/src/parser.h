@@ -1,8 +1,10 @@
 #pragma once
 /// Ultra-fast CSV parser using mmap (C++ version).
-/// Direct equivalent of the Rust parser: mmap + manual byte parsing.
+/// mmap + SIMD structural index for field boundaries + SWAR field parsing.
 
+#include <bit>
 #include <vector>
+#include <cstdio>
 #include <cstring>
 #include <cstdlib>
 #include <fcntl.h>
@@ -12,10 +14,23 @@
 #include <string>
 #include <string_view>
 #include "types.h"
+#include "instrument.h"
+#include "decimal_parser.h"
+#include "structural_index.h"
 
 class CsvReader {
 public:
-    static std::vector<Update> parse_file(const char* path) {
+    /// Parse the whole file into one UpdateLog (updates + snapshot arena).
+    static UpdateLog parse_file(const char* path,
+                                const Instrument& inst = Instrument::btc_usdt()) {
+        return parse_file_as<UpdateLog>(path, inst);
+    }
+
+    /// Parse the whole file into any sink that provides reserve(),
+    /// push(const Update&) and a `levels` arena (UpdateLog, UpdateColumns).
+    template <typename Sink>
+    static Sink parse_file_as(const char* path,
+                              const Instrument& inst = Instrument::btc_usdt()) {
         // Open and mmap the file
         int fd = open(path, O_RDONLY);
         if (fd < 0) {
@@ -37,134 +52,157 @@ public:
         madvise(const_cast<char*>(data), size, MADV_SEQUENTIAL);
         close(fd);
 
-        std::vector<Update> updates;
-        updates.reserve(4096);
-
-        const char* end = data + size;
-        const char* pos = data;
+        Sink out;
+        out.reserve(4096);
 
         // Skip header line
-        pos = skip_line(pos, end);
+        const char* body = skip_line(data, data + size);
+        const bool ok = parse_buffer(body, static_cast<size_t>(data + size - body), inst, out);
 
-        while (pos < end) {
-            const char* line_start = pos;
-            const char* newline = find_newline(pos, end);
-            const char* content_end = newline;
+        munmap(const_cast<char*>(data), size);
+        if (!ok) {
+            fprintf(stderr, "%s: more than %zu snapshot levels\n", path, UpdateLog::MAX_LEVELS);
+            return {};
+        }
+        return out;
+    }
 
-            // Strip \r if present (CRLF handling)
-            if (content_end > line_start && *(content_end - 1) == '\r') {
-                content_end--;
+    /// Parse CSV lines (no header) from [data, data + size) into `out`.
+    /// Field boundaries come from the structural index: the buffer is
+    /// classified 64 bytes at a time and unquoted commas/newlines are
+    /// visited by bit iteration. `Scanner` picks the block classifier.
+    /// A line with an unbalanced quote, or with more than LineFields::MAX
+    /// fields, is skipped. Returns false if the level arena has outgrown
+    /// UpdateLog::MAX_LEVELS, in which case snapshot offsets in `out` are
+    /// not usable.
+    template <typename Sink, typename Scanner = SimdBlockScanner>
+    static bool parse_buffer(const char* data, size_t size,
+                             const Instrument& inst, Sink& out) {
+        using Index = StructuralIndex<Scanner>;
+        const char* end = data + size;
+        Index index;
+        LineFields line;
+        line.start = data;
+
+        for (const char* block = data; block < end; block += Index::BLOCK) {
+            const char* src = block;
+            char tail[Index::BLOCK];
+            const size_t left = static_cast<size_t>(end - block);
+            if (left < Index::BLOCK) {
+                // Last partial block: pad with a byte that is never structural.
+                std::memset(tail, ' ', sizeof(tail));
+                std::memcpy(tail, block, left);
+                src = tail;
             }
 
-            // Advance past \n
-            pos = (newline < end) ? newline + 1 : newline;
-
-            if (content_end <= line_start) continue;
-
-            parse_line(line_start, content_end, updates);
+            const auto s = index.next(src);
+            for (uint64_t bits = s.comma | s.newline; bits; bits &= bits - 1) {
+                const unsigned i = static_cast<unsigned>(std::countr_zero(bits));
+                const char* p = block + i;
+                if ((s.newline >> i) & 1) {
+                    if (!((s.unbalanced >> i) & 1)) finish_line(line, p, inst, out);
+                    line.start = p + 1;
+                    line.count = 0;
+                    line.overflow = false;
+                } else if (line.count < LineFields::MAX - 1) {
+                    line.ends[line.count++] = p;
+                } else {
+                    line.overflow = true;
+                }
+            }
         }
-
-        munmap(const_cast<char*>(data), size);
-        return updates;
+        if (line.start < end && !index.in_quote()) finish_line(line, end, inst, out);
+        return out.levels.size() <= UpdateLog::MAX_LEVELS;
     }
 
 private:
-    static const char* skip_line(const char* pos, const char* end) {
-        while (pos < end && *pos != '\n') ++pos;
-        return (pos < end) ? pos + 1 : pos;
-    }
+    /// Field boundaries of one line: field i spans
+    /// [i ? ends[i - 1] + 1 : start, ends[i]).
+    struct LineFields {
+        static constexpr uint32_t MAX = 9;
+        const char* start = nullptr;
+        const char* ends[MAX];
+        uint32_t count = 0;
+        bool overflow = false; // more than MAX fields: malformed, rejected
+
+        std::string_view field(uint32_t i) const {
+            const char* b = i ? ends[i - 1] + 1 : start;
+            return {b, static_cast<size_t>(ends[i] - b)};
+        }
+    };
 
-    static const char* find_newline(const char* pos, const char* end) {
-        // Use memchr for SIMD-accelerated scan
+    static const char* skip_line(const char* pos, const char* end) {
         const char* nl = static_cast<const char*>(memchr(pos, '\n', end - pos));
-        return nl ? nl : end;
+        return nl ? nl + 1 : end;
     }
 
-    static void parse_line(const char* start, const char* end, std::vector<Update>& out) {
-        if (start >= end) return;
-
-        if (*start == 's') {
-            parse_snapshot(start, end, out);
-        } else if (*start == 'i') {
-            parse_incremental(start, end, out);
+    /// Close the line at `newline` (or end of buffer) and dispatch it.
+    template <typename Sink>
+    static void finish_line(LineFields& line, const char* newline,
+                            const Instrument& inst, Sink& out) {
+        const char* content_end = newline;
+        // Strip \r if present (CRLF handling)
+        if (content_end > line.start && *(content_end - 1) == '\r') content_end--;
+        if (content_end <= line.start || line.overflow) return;
+        line.ends[line.count++] = content_end;
+
+        if (*line.start == 's') {
+            parse_snapshot(line, inst, out);
+        } else if (*line.start == 'i') {
+            parse_incremental(line, inst, out);
         }
     }
 
     /// Parse: incremental,binance,BTC/USDT,<ts>,bid/ask,,,<price>,<size>
-    static void parse_incremental(const char* start, const char* end, std::vector<Update>& out) {
-        Update u;
+    /// A price off the instrument's tick grid rejects the line.
+    template <typename Sink>
+    static void parse_incremental(const LineFields& line, const Instrument& inst, Sink& out) {
+        Update u{};
         u.type = Update::Type::Incremental;
 
-        int field = 0;
-        const char* field_start = start;
-
-        for (const char* p = start; ; ++p) {
-            bool at_end = (p == end);
-            bool at_comma = (!at_end && *p == ',');
-
-            if (at_comma || at_end) {
-                switch (field) {
-                    case 3: // timestamp
-                        u.timestamp = parse_u64(field_start, p);
-                        break;
-                    case 4: // side
-                        u.side = (*field_start == 'b') ? Side::Bid : Side::Ask;
-                        break;
-                    case 7: // price
-                        u.level.price = Price::from_f64(parse_double(field_start, p));
-                        break;
-                    case 8: // size
-                        u.level.qty = Qty(parse_double(field_start, p));
-                        break;
-                }
-                field_start = p + 1;
-                ++field;
-            }
-            if (at_end) break;
+        if (line.count > 3) {
+            auto ts = line.field(3);
+            u.timestamp = DecimalParser::parse_u64(ts.data(), ts.data() + ts.size());
+        }
+        if (line.count > 4) {
+            u.side = (line.field(4).data()[0] == 'b') ? Side::Bid : Side::Ask;
+        }
+        if (line.count > 7) {
+            auto price = line.field(7);
+            const uint64_t scaled =
+                DecimalParser::parse_fixed(price.data(), price.data() + price.size(), inst.price_decimals);
+            if (!inst.on_tick(scaled)) return; // off the tick grid: rejected
+            u.level.price = inst.price_from_scaled(scaled);
+        }
+        if (line.count > 8) {
+            auto size = line.field(8);
+            u.level.qty = Qty(DecimalParser::parse_fixed(size.data(), size.data() + size.size(), inst.qty_decimals));
         }
 
-        out.push_back(std::move(u));
+        out.push(u);
     }
 
-    /// Parse snapshot with JSON bid/ask arrays.
-    static void parse_snapshot(const char* start, const char* end, std::vector<Update>& out) {
-        Update u;
-        u.type = Update::Type::Snapshot;
+    /// Parse snapshot with JSON bid/ask arrays. The quoted arrays arrive as
+    /// single fields: their inner commas were masked out by the index.
+    template <typename Sink>
+    static void parse_snapshot(const LineFields& line, const Instrument& inst, Sink& out) {
+        if (line.count < 7) return;
 
-        // Parse fields respecting quotes (JSON arrays contain commas)
-        std::vector<std::string_view> fields;
-        fields.reserve(9);
-        const char* fs = start;
-        bool in_quotes = false;
-
-        for (const char* p = start; ; ++p) {
-            bool at_end = (p == end);
-            if (!at_end) {
-                if (*p == '"') in_quotes = !in_quotes;
-                if (*p == ',' && !in_quotes) {
-                    fields.emplace_back(fs, p - fs);
-                    fs = p + 1;
-                    continue;
-                }
-            }
-            if (at_end) {
-                fields.emplace_back(fs, p - fs);
-                break;
-            }
-        }
-
-        if (fields.size() < 7) return;
+        Update u{};
+        u.type = Update::Type::Snapshot;
 
-        u.timestamp = parse_u64(fields[3].data(), fields[3].data() + fields[3].size());
+        auto ts = line.field(3);
+        u.timestamp = DecimalParser::parse_u64(ts.data(), ts.data() + ts.size());
 
         // Parse bids JSON: strip quotes, then parse [[price, size], ...]
-        auto bids_sv = strip_quotes(fields[5]);
-        auto asks_sv = strip_quotes(fields[6]);
+        auto bids_sv = strip_quotes(line.field(5));
+        auto asks_sv = strip_quotes(line.field(6));
 
-        u.bids = parse_levels_json(bids_sv);
-        u.asks = parse_levels_json(asks_sv);
+        u.levels_begin = static_cast<uint32_t>(out.levels.size());
+        u.bid_count = parse_levels_json(bids_sv, inst, out.levels);
+        u.ask_count = parse_levels_json(asks_sv, inst, out.levels);
 
-        out.push_back(std::move(u));
+        out.push(u);
     }
 
     static std::string_view strip_quotes(std::string_view sv) {
@@ -174,10 +212,49 @@ private:
         return sv;
     }
 
-    /// Parse [[price, size], [price, size], ...] manually for speed.
-    static std::vector<Level> parse_levels_json(std::string_view sv) {
-        std::vector<Level> levels;
-        levels.reserve(16);
+public:
+    /// Parse [[price, size], [price, size], ...] into `levels`, returning
+    /// the number of levels appended. The pairs are counted first (every
+    /// pair holds one comma and is followed by one, so n pairs hold 2n - 1
+    /// commas, counted 64 bytes at a time by the block scanner) and the
+    /// arena is grown once to the exact size. Each pair is then cut with
+    /// three 16-byte delimiter searches instead of a per-character loop.
+    /// A level whose price is off the instrument's tick grid is dropped.
+    static uint32_t parse_levels_json(std::string_view sv, const Instrument& inst,
+                                      std::vector<Level>& levels) {
+        const size_t first = levels.size();
+        const size_t pairs = (count_commas(sv.data(), sv.size()) + 1) / 2;
+        levels.resize(first + pairs);
+        Level* out = levels.data() + first;
+
+        const char* p = sv.data();
+        const char* end = p + sv.size();
+        size_t n = 0, kept = 0;
+        // Skip the outer '[' so `p` sits on the first pair's '['.
+        p = find_byte(p, end, '[');
+        if (p < end) p = find_byte(p + 1, end, '[');
+        for (; n < pairs && p < end; ++n) {
+            const char* price = skip_blanks(p + 1, end);
+            const char* comma = find_byte(price, end, ',');
+            const char* size = skip_blanks(comma + (comma < end), end);
+            const char* close = find_byte(size, end, ']');
+            const uint64_t scaled = DecimalParser::parse_fixed(price, comma, inst.price_decimals);
+            out[kept] = Level{inst.price_from_scaled(scaled),
+                              Qty(DecimalParser::parse_fixed(size, close, inst.qty_decimals))};
+            kept += inst.on_tick(scaled); // an off-tick level is overwritten by the next
+            // ", [" normally follows: the next '[' is two or three bytes on.
+            p = find_byte(close, end, '[');
+        }
+        levels.resize(first + kept); // malformed input may hold fewer pairs
+        return static_cast<uint32_t>(kept);
+    }
+
+    /// Reference state machine that scans for brackets a byte at a time
+    /// and appends level by level. Kept as the benchmark baseline; drops
+    /// off-tick levels like parse_levels_json.
+    static uint32_t parse_levels_json_scalar(std::string_view sv, const Instrument& inst,
+                                             std::vector<Level>& levels) {
+        const size_t first = levels.size();
 
         // State machine: find pairs of numbers between [ ]
         const char* p = sv.data();
@@ -195,7 +272,7 @@ private:
             while (p < end && (*p == ' ' || *p == '\t')) ++p;
             const char* num_start = p;
             while (p < end && *p != ',' && *p != ']') ++p;
-            double price = parse_double(num_start, p);
+            const uint64_t scaled = DecimalParser::parse_fixed(num_start, p, inst.price_decimals);
 
             // Skip comma
             if (p < end && *p == ',') ++p;
@@ -204,32 +281,51 @@ private:
             while (p < end && (*p == ' ' || *p == '\t')) ++p;
             num_start = p;
             while (p < end && *p != ']') ++p;
-            double size = parse_double(num_start, p);
+            uint64_t lots = DecimalParser::parse_fixed(num_start, p, inst.qty_decimals);
 
-            levels.push_back(Level{Price::from_f64(price), Qty(size)});
+            if (inst.on_tick(scaled)) levels.push_back(Level{inst.price_from_scaled(scaled), Qty(lots)});
 
             if (p < end) ++p; // skip ']'
         }
 
-        return levels;
+        return static_cast<uint32_t>(levels.size() - first);
+    }
+
+private:
+    /// Commas in [p, p + n), by popcount over the scanner's comma masks.
+    static size_t count_commas(const char* p, size_t n) {
+        size_t commas = 0;
+        size_t i = 0;
+        for (; i + 64 <= n; i += 64) {
+            commas += static_cast<size_t>(std::popcount(SimdBlockScanner::classify(p + i).comma));
+        }
+        if (i < n) {
+            char tail[64];
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, p + i, n - i);
+            commas += static_cast<size_t>(std::popcount(SimdBlockScanner::classify(tail).comma));
+        }
+        return commas;
     }
 
-    /// Fast u64 parsing from ASCII.
-    static uint64_t parse_u64(const char* start, const char* end) {
-        uint64_t result = 0;
-        for (const char* p = start; p < end; ++p) {
-            result = result * 10 + static_cast<uint64_t>(*p - '0');
+    /// First `c` in [p, end), or `end`. Delimiters in a level array are at
+    /// most a number's width apart, so one 16-byte compare usually finds
+    /// it; the last few bytes of the array fall back to memchr.
+    static const char* find_byte(const char* p, const char* end, char c) {
+#if defined(__SSE2__)
+        if (end - p >= 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const unsigned hit = static_cast<unsigned>(
+                _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c))));
+            if (hit) return p + std::countr_zero(hit);
         }
-        return result;
+#endif
+        const char* q = static_cast<const char*>(memchr(p, c, static_cast<size_t>(end - p)));
+        return q ? q : end;
     }
 
-    /// Fast double parsing.
-    static double parse_double(const char* start, const char* end) {
-        // strtod needs null-terminated string, use a small buffer
-        char buf[64];
-        size_t len = std::min(static_cast<size_t>(end - start), sizeof(buf) - 1);
-        memcpy(buf, start, len);
-        buf[len] = '\0';
-        return strtod(buf, nullptr);
+    static const char* skip_blanks(const char* p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t')) ++p;
+        return p;
     }
 };
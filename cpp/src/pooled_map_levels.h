@@ -0,0 +1,56 @@
+#pragma once
+/// std::map level store with per-book pooled node allocation.
+/// Same red-black tree as MapLevels, but nodes come from a std::pmr
+/// unsynchronized pool layered on a monotonic arena that is preallocated at
+/// construction. Erased nodes go back to the pool and the next insert reuses
+/// them, so once the book has seen its working set of levels, incremental
+/// processing makes no heap allocations.
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include "types.h"
+#include "orderbook.h"
+
+template <Side S>
+class PooledMapLevels {
+public:
+    /// Arena reserved per side up front (~10k tree nodes); the pool spills
+    /// to the heap only if a side outgrows it.
+    static constexpr size_t ARENA_BYTES = 512 * 1024;
+
+    PooledMapLevels()
+        : arena_buf_(std::make_unique<std::byte[]>(ARENA_BYTES)),
+          arena_(arena_buf_.get(), ARENA_BYTES),
+          pool_(&arena_),
+          levels_(&pool_) {}
+
+    PooledMapLevels(const PooledMapLevels&) = delete;
+    PooledMapLevels& operator=(const PooledMapLevels&) = delete;
+
+    void clear() { levels_.clear(); }
+    void set(Price price, Qty qty) { levels_[price.raw] = qty.lots; }
+    void erase(Price price) { levels_.erase(price.raw); }
+    size_t size() const { return levels_.size(); }
+
+    std::optional<Level> best() const {
+        if (levels_.empty()) return std::nullopt;
+        if constexpr (S == Side::Bid) {
+            auto it = levels_.rbegin();
+            return Level{Price(it->first), Qty(it->second)};
+        } else {
+            auto it = levels_.begin();
+            return Level{Price(it->first), Qty(it->second)};
+        }
+    }
+
+private:
+    // Declaration order is construction order: buffer, arena, pool, map.
+    std::unique_ptr<std::byte[]>           arena_buf_;
+    std::pmr::monotonic_buffer_resource    arena_;
+    std::pmr::unsynchronized_pool_resource pool_;
+    std::pmr::map<uint64_t, uint64_t>      levels_;
+};
+
+using PooledOrderbook = BasicOrderbook<PooledMapLevels>;
@@ -0,0 +1,157 @@
+#pragma once
+/// Flat price-ladder level store (alternative to the std::map book).
+/// Each side is a contiguous array of quantities indexed by tick offset from
+/// a window base, so insert/erase/update are O(1) array writes. When a price
+/// lands outside the window it is recentred on the live levels (which
+/// straddle the touch), and doubled if they no longer fit in half of it.
+/// An occupancy bitmap finds the next level after a top-of-book delete.
+///
+/// The window never grows past `max_ticks`. A price that cannot share the
+/// window with the live levels (a fat-finger quote, a stale level after a
+/// large move) is kept in a std::map on the side instead, and moves into
+/// the window if a later recentre covers it.
+
+#include <algorithm>
+#include <map>
+#include <vector>
+#include "types.h"
+#include "orderbook.h"
+#include "occupancy_bitmap.h"
+
+/// One side of the ladder. Bids treat the high end of the window as best,
+/// asks the low end.
+template <Side S>
+class PriceLadder {
+public:
+    static constexpr size_t DEFAULT_TICKS = 4096;
+    static constexpr size_t DEFAULT_MAX_TICKS = size_t{1} << 20; // 8 MiB of quantities
+
+    explicit PriceLadder(size_t ticks = DEFAULT_TICKS, size_t max_ticks = DEFAULT_MAX_TICKS)
+        : qty_(ticks, 0), occupied_(ticks), max_ticks_(std::max(ticks, max_ticks)) {}
+
+    void clear() {
+        occupied_.for_each([this](size_t i) { qty_[i] = 0; });
+        occupied_.clear();
+        count_ = 0;
+        far_.clear();
+    }
+
+    /// Insert or overwrite the level at `price`.
+    void set(Price price, Qty qty) {
+        if (!in_window(price.raw) && !recenter(price.raw)) {
+            far_[price.raw] = qty.lots;
+            return;
+        }
+        size_t i = price.raw - base_;
+        if (qty_[i] == 0) {
+            occupied_.set(i);
+            if (count_++ == 0 || better(i, best_)) best_ = i;
+        }
+        qty_[i] = qty.lots;
+    }
+
+    /// Remove the level at `price` (no-op if absent).
+    void erase(Price price) {
+        if (!in_window(price.raw)) {
+            if (!far_.empty()) far_.erase(price.raw);
+            return;
+        }
+        size_t i = price.raw - base_;
+        if (qty_[i] == 0) return;
+        qty_[i] = 0;
+        occupied_.reset(i);
+        if (--count_ > 0 && i == best_) best_ = next_worse(i);
+    }
+
+    std::optional<Level> best() const {
+        if (far_.empty()) {
+            if (count_ == 0) return std::nullopt;
+            return Level{Price(base_ + best_), Qty(qty_[best_])};
+        }
+        const auto far = (S == Side::Bid) ? std::prev(far_.end()) : far_.begin();
+        if (count_ == 0 || better(far->first, base_ + best_)) {
+            return Level{Price(far->first), Qty(far->second)};
+        }
+        return Level{Price(base_ + best_), Qty(qty_[best_])};
+    }
+
+    size_t size() const { return count_ + far_.size(); }
+
+    /// Current window width in ticks (at most max_ticks).
+    size_t window_ticks() const { return qty_.size(); }
+
+    /// Levels held outside the window.
+    size_t far_levels() const { return far_.size(); }
+
+private:
+    std::vector<uint64_t> qty_; // 0 = empty level
+    OccupancyBitmap occupied_;  // bit i set <=> qty_[i] != 0
+    std::map<uint64_t, uint64_t> far_; // levels outside the window
+    size_t   max_ticks_;
+    uint64_t base_  = 0;        // price (ticks) of qty_[0]
+    size_t   count_ = 0;
+    size_t   best_  = 0;        // valid only when count_ > 0
+
+    /// True if `a` is nearer the touch than `b` (slots or prices).
+    static bool better(uint64_t a, uint64_t b) {
+        return S == Side::Bid ? a > b : a < b;
+    }
+
+    bool in_window(uint64_t raw) const {
+        return raw >= base_ && raw - base_ < qty_.size();
+    }
+
+    /// Next occupied slot from `i` away from the touch. Only called while
+    /// another level remains, so the neighbour index is always in range.
+    size_t next_worse(size_t i) const {
+        if constexpr (S == Side::Bid) {
+            return occupied_.find_prev(i - 1);
+        } else {
+            return occupied_.find_next(i + 1);
+        }
+    }
+
+    /// Move the window so that every live level plus `raw` fits, centred on
+    /// the occupied range. Rare: only when price drifts past the window edge.
+    /// Returns false, leaving the window as it is, if that would take more
+    /// than max_ticks.
+    bool recenter(uint64_t raw) {
+        uint64_t lo = raw, hi = raw;
+        if (count_ > 0) {
+            lo = std::min(lo, base_ + occupied_.find_next(0));
+            hi = std::max(hi, base_ + occupied_.find_prev(qty_.size() - 1));
+        }
+
+        size_t ticks = qty_.size();
+        while (hi - lo + 1 > ticks / 2 && ticks < max_ticks_) ticks = std::min(ticks * 2, max_ticks_);
+        if (hi - lo + 1 >= ticks) return false;
+
+        uint64_t mid = lo + (hi - lo) / 2;
+        uint64_t new_base = (mid > ticks / 2) ? mid - ticks / 2 : 0;
+
+        std::vector<uint64_t> moved(ticks, 0);
+        OccupancyBitmap moved_occupied(ticks);
+        occupied_.for_each([&](size_t i) {
+            size_t j = base_ + i - new_base;
+            moved[j] = qty_[i];
+            moved_occupied.set(j);
+        });
+        best_ = best_ + base_ - new_base;
+        base_ = new_base;
+        qty_.swap(moved);
+        occupied_ = std::move(moved_occupied);
+
+        // Pull in far levels the new window now covers.
+        auto it = far_.lower_bound(base_);
+        while (it != far_.end() && it->first - base_ < ticks) {
+            const size_t i = it->first - base_;
+            qty_[i] = it->second;
+            occupied_.set(i);
+            if (count_++ == 0 || better(i, best_)) best_ = i;
+            it = far_.erase(it);
+        }
+        return true;
+    }
+};
+
+using LadderOrderbook = BasicOrderbook<PriceLadder>;
@@ -2,12 +2,24 @@
 /// Lock-free SPSC (Single Producer, Single Consumer) bounded ring buffer.
 /// Cache-line padded to avoid false sharing. Direct equivalent of
 /// crossbeam bounded channel in the Rust version.
+///
+/// The producer owns `head_` and the consumer owns `tail_`; each side
+/// publishes with one release store of its index. The bulk calls claim
+/// every slot they can, copy the run, and publish it with that one store,
+/// so a batch of N costs one cache-line handoff instead of N.
+///
+/// emplace() builds an element directly in its slot, and front() /
+/// pop_commit() let the consumer read elements where they lie and release
+/// them afterwards, so neither side copies the element on the hot path.
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <new>
-#include <cstring>
+#include <span>
+#include <utility>
 
 #ifdef __cpp_lib_hardware_interference_size
     inline constexpr size_t CACHE_LINE = std::hardware_destructive_interference_size;
@@ -15,13 +27,21 @@
     inline constexpr size_t CACHE_LINE = 64;
 #endif
 
+/// Spin-wait hint for busy loops.
+inline void cpu_relax() {
+#if defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
 template <typename T, size_t Capacity>
 class SPSCQueue {
     static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be power of 2");
     static constexpr size_t MASK = Capacity - 1;
 
-    struct alignas(CACHE_LINE) Slot {
-        std::atomic<uint64_t> seq;
+    struct Slot {
         alignas(T) unsigned char storage[sizeof(T)];
 
         T* ptr() { return reinterpret_cast<T*>(storage); }
@@ -29,82 +49,167 @@ class SPSCQueue {
     };
 
     // Producer and consumer positions on separate cache lines to avoid false sharing
-    alignas(CACHE_LINE) std::atomic<uint64_t> head_{0};   // producer writes here
-    alignas(CACHE_LINE) std::atomic<uint64_t> tail_{0};   // consumer reads here
+    alignas(CACHE_LINE) std::atomic<uint64_t> head_{0};   // next write; producer stores
+    alignas(CACHE_LINE) std::atomic<uint64_t> tail_{0};   // next read; consumer stores
     alignas(CACHE_LINE) Slot slots_[Capacity];
 
 public:
-    SPSCQueue() {
-        for (size_t i = 0; i < Capacity; ++i) {
-            slots_[i].seq.store(i, std::memory_order_relaxed);
+    static constexpr size_t CAPACITY = Capacity;
+
+    SPSCQueue() = default;
+
+    ~SPSCQueue() {
+        for (uint64_t i = tail_.load(std::memory_order_relaxed);
+             i != head_.load(std::memory_order_relaxed); ++i) {
+            slots_[i & MASK].ptr()->~T();
         }
     }
 
     /// Try to push an element. Returns false if full.
     bool try_push(const T& item) {
-        uint64_t pos = head_.load(std::memory_order_relaxed);
-        Slot& slot = slots_[pos & MASK];
-        uint64_t seq = slot.seq.load(std::memory_order_acquire);
-        if (seq != pos) return false; // full
-        head_.store(pos + 1, std::memory_order_relaxed);
-        new (slot.storage) T(item);
-        slot.seq.store(pos + 1, std::memory_order_release);
-        return true;
+        return try_push_bulk(std::span<const T>(&item, 1)) == 1;
     }
 
     /// Blocking push — spins until slot available.
     void push(const T& item) {
-        uint64_t pos = head_.load(std::memory_order_relaxed);
-        Slot& slot = slots_[pos & MASK];
-        while (slot.seq.load(std::memory_order_acquire) != pos) {
+        push_bulk(std::span<const T>(&item, 1));
+    }
+
+    /// Construct an element in the next free slot from `args`. Returns
+    /// false if full.
+    template <typename... Args>
+    bool try_emplace(Args&&... args) {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        if (!writable(head)) return false;
+        new (slots_[head & MASK].storage) T(std::forward<Args>(args)...);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Blocking emplace — spins until slot available. The element is built
+    /// in the ring, so nothing is copied on the way in.
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        while (!writable(head)) cpu_relax();
+        new (slots_[head & MASK].storage) T(std::forward<Args>(args)...);
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    /// Push as many of `items` as there is room for, published with one
+    /// release store. Returns the number pushed (0 if full).
+    size_t try_push_bulk(std::span<const T> items) {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        const uint64_t room = Capacity - (head - tail_.load(std::memory_order_acquire));
+        const size_t n = std::min<uint64_t>(items.size(), room);
+        for (size_t i = 0; i < n; ++i) {
+            new (slots_[(head + i) & MASK].storage) T(items[i]);
+        }
+        if (n > 0) head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    /// Blocking bulk push — spins until every item is in. A run longer
+    /// than the free space is published in pieces as room appears.
+    void push_bulk(std::span<const T> items) {
+        while (!items.empty()) {
+            const size_t n = try_push_bulk(items);
+            items = items.subspan(n);
             // spin — for SPSC with fast consumer this rarely iterates
-            #if defined(__x86_64__)
-                __builtin_ia32_pause();
-            #elif defined(__aarch64__)
-                asm volatile("yield");
-            #endif
+            if (n == 0) cpu_relax();
         }
-        head_.store(pos + 1, std::memory_order_relaxed);
-        new (slot.storage) T(item);
-        slot.seq.store(pos + 1, std::memory_order_release);
     }
 
     /// Try to pop an element. Returns nullopt if empty.
     std::optional<T> try_pop() {
-        uint64_t pos = tail_.load(std::memory_order_relaxed);
-        Slot& slot = slots_[pos & MASK];
-        uint64_t seq = slot.seq.load(std::memory_order_acquire);
-        if (seq != pos + 1) return std::nullopt; // empty
-        tail_.store(pos + 1, std::memory_order_relaxed);
-        T item = std::move(*slot.ptr());
-        slot.ptr()->~T();
-        slot.seq.store(pos + Capacity, std::memory_order_release);
-        return item;
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (head_.load(std::memory_order_acquire) == tail) return std::nullopt; // empty
+        return take(tail);
     }
 
     /// Blocking pop — spins until element available.
     /// Returns nullopt only if `closed` flag is set and queue is empty.
     std::optional<T> pop(const std::atomic<bool>& closed) {
-        uint64_t pos = tail_.load(std::memory_order_relaxed);
-        Slot& slot = slots_[pos & MASK];
-        while (true) {
-            uint64_t seq = slot.seq.load(std::memory_order_acquire);
-            if (seq == pos + 1) break; // data ready
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        while (head_.load(std::memory_order_acquire) == tail) {
             if (closed.load(std::memory_order_acquire)) {
                 // Check one more time in case producer wrote between checks
-                if (slot.seq.load(std::memory_order_acquire) == pos + 1) break;
+                if (head_.load(std::memory_order_acquire) != tail) break;
                 return std::nullopt;
             }
-            #if defined(__x86_64__)
-                __builtin_ia32_pause();
-            #elif defined(__aarch64__)
-                asm volatile("yield");
-            #endif
+            cpu_relax();
+        }
+        return take(tail);
+    }
+
+    /// Number of elements ready to read in place (0 if empty).
+    size_t ready() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+    }
+
+    /// Number of elements ready to read in place. Spins until there is at
+    /// least one; returns 0 only if `closed` is set and the queue is empty.
+    size_t wait_ready(const std::atomic<bool>& closed) {
+        while (true) {
+            if (size_t n = ready()) return n;
+            if (closed.load(std::memory_order_acquire)) return ready();
+            cpu_relax();
+        }
+    }
+
+    /// The i-th unread element, in its slot. Requires i < the count from
+    /// ready() or wait_ready(); valid until pop_commit() passes it.
+    T& front(size_t i = 0) {
+        return *slots_[(tail_.load(std::memory_order_relaxed) + i) & MASK].ptr();
+    }
+
+    /// Destroy the first `n` unread elements and hand their slots back to
+    /// the producer with one store.
+    void pop_commit(size_t n = 1) {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < n; ++i) slots_[(tail + i) & MASK].ptr()->~T();
+        tail_.store(tail + n, std::memory_order_release);
+    }
+
+    /// Move up to out.size() queued elements into `out`, released back to
+    /// the producer with one store. Returns the number popped (0 if empty).
+    size_t try_pop_bulk(std::span<T> out) {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        const uint64_t avail = head_.load(std::memory_order_acquire) - tail;
+        const size_t n = std::min<uint64_t>(out.size(), avail);
+        for (size_t i = 0; i < n; ++i) {
+            T* item = slots_[(tail + i) & MASK].ptr();
+            out[i] = std::move(*item);
+            item->~T();
+        }
+        if (n > 0) tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    /// Blocking bulk pop — spins until at least one element is available,
+    /// then drains what is there (up to out.size()). Returns 0 only if
+    /// `closed` is set and the queue is empty.
+    size_t pop_bulk(std::span<T> out, const std::atomic<bool>& closed) {
+        while (true) {
+            if (size_t n = try_pop_bulk(out)) return n;
+            if (closed.load(std::memory_order_acquire)) {
+                // Drain anything published before the flag was seen
+                return try_pop_bulk(out);
+            }
+            cpu_relax();
         }
-        tail_.store(pos + 1, std::memory_order_relaxed);
-        T item = std::move(*slot.ptr());
-        slot.ptr()->~T();
-        slot.seq.store(pos + Capacity, std::memory_order_release);
+    }
+
+private:
+    bool writable(uint64_t head) const {
+        return head - tail_.load(std::memory_order_acquire) < Capacity;
+    }
+
+    T take(uint64_t tail) {
+        T* slot = slots_[tail & MASK].ptr();
+        T item = std::move(*slot);
+        slot->~T();
+        tail_.store(tail + 1, std::memory_order_release);
         return item;
     }
 };
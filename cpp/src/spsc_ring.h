@@ -0,0 +1,216 @@
+#pragma once
+/// SPSC ring with cached opposite indices (Rigtorp / folly ProducerConsumerQueue
+/// style). Same interface as SPSCQueue, so run_strategy takes either.
+///
+/// SPSCQueue reads the other side's index on every call, so each push pulls
+/// the consumer's cache line over (and each pop the producer's). Here each
+/// side keeps a private copy of the other's index next to its own and only
+/// reloads it when the copy says the ring is full (producer) or empty
+/// (consumer). In steady state the only shared traffic is the slot data
+/// and one index store per publish. Slots are packed densely, with a cache
+/// line of padding at both ends of the array so neighbouring objects never
+/// share a line with the first or last slot.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <new>
+#include <span>
+#include <utility>
+#include "spsc_queue.h"
+
+template <typename T, size_t Capacity>
+class SPSCRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be power of 2");
+    static constexpr size_t MASK = Capacity - 1;
+    static constexpr size_t PAD = (CACHE_LINE + sizeof(T) - 1) / sizeof(T);
+
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* ptr() { return reinterpret_cast<T*>(storage); }
+    };
+
+    // Producer line: its index plus its view of the consumer's.
+    alignas(CACHE_LINE) std::atomic<uint64_t> head_{0};
+    uint64_t tail_cache_ = 0;
+    // Consumer line: its index plus its view of the producer's.
+    alignas(CACHE_LINE) std::atomic<uint64_t> tail_{0};
+    uint64_t head_cache_ = 0;
+    alignas(CACHE_LINE) Slot slots_[Capacity + 2 * PAD];
+
+    Slot& slot(uint64_t i) { return slots_[PAD + (i & MASK)]; }
+
+public:
+    static constexpr size_t CAPACITY = Capacity;
+
+    SPSCRing() = default;
+
+    ~SPSCRing() {
+        for (uint64_t i = tail_.load(std::memory_order_relaxed);
+             i != head_.load(std::memory_order_relaxed); ++i) {
+            slot(i).ptr()->~T();
+        }
+    }
+
+    /// Try to push an element. Returns false if full.
+    bool try_push(const T& item) {
+        return try_push_bulk(std::span<const T>(&item, 1)) == 1;
+    }
+
+    /// Blocking push — spins until slot available.
+    void push(const T& item) {
+        push_bulk(std::span<const T>(&item, 1));
+    }
+
+    /// Construct an element in the next free slot from `args`. Returns
+    /// false if full.
+    template <typename... Args>
+    bool try_emplace(Args&&... args) {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        if (!writable(head)) return false;
+        new (slot(head).storage) T(std::forward<Args>(args)...);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Blocking emplace — spins until slot available. The element is built
+    /// in the ring, so nothing is copied on the way in.
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        while (!writable(head)) cpu_relax();
+        new (slot(head).storage) T(std::forward<Args>(args)...);
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    /// Push as many of `items` as there is room for, published with one
+    /// release store. Returns the number pushed (0 if full).
+    size_t try_push_bulk(std::span<const T> items) {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        uint64_t room = Capacity - (head - tail_cache_);
+        if (room < items.size()) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            room = Capacity - (head - tail_cache_);
+        }
+        const size_t n = std::min<uint64_t>(items.size(), room);
+        for (size_t i = 0; i < n; ++i) new (slot(head + i).storage) T(items[i]);
+        if (n > 0) head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    /// Blocking bulk push — spins until every item is in.
+    void push_bulk(std::span<const T> items) {
+        while (!items.empty()) {
+            const size_t n = try_push_bulk(items);
+            items = items.subspan(n);
+            if (n == 0) cpu_relax();
+        }
+    }
+
+    /// Try to pop an element. Returns nullopt if empty.
+    std::optional<T> try_pop() {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (!readable(tail)) return std::nullopt;
+        return take(tail);
+    }
+
+    /// Blocking pop — spins until element available.
+    /// Returns nullopt only if `closed` flag is set and queue is empty.
+    std::optional<T> pop(const std::atomic<bool>& closed) {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        while (!readable(tail)) {
+            if (closed.load(std::memory_order_acquire)) {
+                // Check one more time in case producer wrote between checks
+                if (readable(tail)) break;
+                return std::nullopt;
+            }
+            cpu_relax();
+        }
+        return take(tail);
+    }
+
+    /// Number of elements ready to read in place (0 if empty).
+    size_t ready() {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        readable(tail);
+        return head_cache_ - tail;
+    }
+
+    /// Number of elements ready to read in place. Spins until there is at
+    /// least one; returns 0 only if `closed` is set and the queue is empty.
+    size_t wait_ready(const std::atomic<bool>& closed) {
+        while (true) {
+            if (size_t n = ready()) return n;
+            if (closed.load(std::memory_order_acquire)) return ready();
+            cpu_relax();
+        }
+    }
+
+    /// The i-th unread element, in its slot. Requires i < the count from
+    /// ready() or wait_ready(); valid until pop_commit() passes it.
+    T& front(size_t i = 0) {
+        return *slot(tail_.load(std::memory_order_relaxed) + i).ptr();
+    }
+
+    /// Destroy the first `n` unread elements and hand their slots back to
+    /// the producer with one store.
+    void pop_commit(size_t n = 1) {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < n; ++i) slot(tail + i).ptr()->~T();
+        tail_.store(tail + n, std::memory_order_release);
+    }
+
+    /// Move up to out.size() queued elements into `out`, released back to
+    /// the producer with one store. Returns the number popped (0 if empty).
+    size_t try_pop_bulk(std::span<T> out) {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (!readable(tail)) return 0;
+        const size_t n = std::min<uint64_t>(out.size(), head_cache_ - tail);
+        for (size_t i = 0; i < n; ++i) {
+            T* item = slot(tail + i).ptr();
+            out[i] = std::move(*item);
+            item->~T();
+        }
+        if (n > 0) tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    /// Blocking bulk pop — spins until at least one element is available,
+    /// then drains what is there (up to out.size()). Returns 0 only if
+    /// `closed` is set and the queue is empty.
+    size_t pop_bulk(std::span<T> out, const std::atomic<bool>& closed) {
+        while (true) {
+            if (size_t n = try_pop_bulk(out)) return n;
+            if (closed.load(std::memory_order_acquire)) return try_pop_bulk(out);
+            cpu_relax();
+        }
+    }
+
+private:
+    /// True if slot `head` is free; refreshes the cached tail only when the
+    /// cached value says the ring is full.
+    bool writable(uint64_t head) {
+        if (head - tail_cache_ < Capacity) return true;
+        tail_cache_ = tail_.load(std::memory_order_acquire);
+        return head - tail_cache_ < Capacity;
+    }
+
+    /// True if slot `tail` holds data; refreshes the cached head only when
+    /// the cached value says the ring is empty.
+    bool readable(uint64_t tail) {
+        if (head_cache_ != tail) return true;
+        head_cache_ = head_.load(std::memory_order_acquire);
+        return head_cache_ != tail;
+    }
+
+    T take(uint64_t tail) {
+        T* item = slot(tail).ptr();
+        T value = std::move(*item);
+        item->~T();
+        tail_.store(tail + 1, std::memory_order_release);
+        return value;
+    }
+};
@@ -1,13 +1,18 @@
 #pragma once
 /// Strategy module — dummy consumer that logs best bid/ask.
-/// Receives BookNotification via SPSC queue, measures latency.
+/// Receives BookNotification via SPSC queue (or, conflated, via a
+/// ConflatingSlot that only holds the latest one, or as one of several
+/// consumers of a BroadcastRing), measures latency.
 
 #include <cstdio>
 #include <vector>
 #include <algorithm>
 #include <atomic>
 #include "types.h"
+#include "instrument.h"
 #include "spsc_queue.h"
+#include "conflating_slot.h"
+#include "broadcast_ring.h"
 #include "clock.h"
 
 struct StrategyStats {
@@ -15,6 +20,7 @@ struct StrategyStats {
     uint64_t total_latency_ns = 0;
     uint64_t min_latency_ns = UINT64_MAX;
     uint64_t max_latency_ns = 0;
+    uint64_t conflated = 0;   // notifications overwritten unread (conflating channel)
     std::vector<uint64_t> latencies;
 
     StrategyStats() { latencies.reserve(8192); }
@@ -40,38 +46,131 @@ struct StrategyStats {
     uint64_t median() const { return percentile(50.0); }
 };
 
+/// Record and (optionally) log one notification received at `recv_ns`.
+/// `work_ns` busy-waits after each one to stand in for strategy logic; the
+/// benchmark uses it to model a consumer slower than the feed.
+inline void on_notification(const BookNotification& notif, uint64_t recv_ns, StrategyStats& stats,
+                            bool log_enabled, const Instrument& inst, uint64_t work_ns) {
+    uint64_t latency_ns = recv_ns - notif.engine_send_ns;
+    stats.record(latency_ns);
+
+    if (log_enabled) {
+        char bid_buf[64] = "EMPTY";
+        char ask_buf[64] = "EMPTY";
+        if (notif.best_bid.has_value()) {
+            snprintf(bid_buf, sizeof(bid_buf), "%.*f @ %.4f", inst.price_decimals,
+                inst.price_to_f64(notif.best_bid->price), inst.qty_to_f64(notif.best_bid->qty));
+        }
+        if (notif.best_ask.has_value()) {
+            snprintf(ask_buf, sizeof(ask_buf), "%.*f @ %.4f", inst.price_decimals,
+                inst.price_to_f64(notif.best_ask->price), inst.qty_to_f64(notif.best_ask->qty));
+        }
+        printf("[strategy] seq=%-6lu ts=%lu | best_bid: %-22s | best_ask: %-22s | lat=%luns\n",
+            notif.seq, notif.update_timestamp, bid_buf, ask_buf, latency_ns);
+    }
+
+    if (work_ns > 0) {
+        const uint64_t until = Clock::now_ns() + work_ns;
+        while (Clock::now_ns() < until) cpu_relax();
+    }
+}
+
 /// Run strategy consumer. Blocks until closed flag is set and queue is drained.
-template <size_t QueueCap>
+/// Each wake-up reads everything the engine has published so far in place
+/// (front(i)) and releases the run with one pop_commit, so a burst costs
+/// one index handoff and no copies.
+/// `Queue` is SPSCQueue or SPSCRing of BookNotification.
+template <typename Queue>
 StrategyStats run_strategy(
-    SPSCQueue<BookNotification, QueueCap>& queue,
+    Queue& queue,
     std::atomic<bool>& closed,
-    bool log_enabled)
+    bool log_enabled,
+    const Instrument& inst = Instrument::btc_usdt(),
+    uint64_t work_ns = 0)
 {
     StrategyStats stats;
 
     while (true) {
-        auto maybe = queue.pop(closed);
-        if (!maybe.has_value()) break;
-
-        const auto& notif = *maybe;
-        uint64_t recv_ns = Clock::now_ns();
-        uint64_t latency_ns = recv_ns - notif.engine_send_ns;
-        stats.record(latency_ns);
-
-        if (log_enabled) {
-            char bid_buf[64] = "EMPTY";
-            char ask_buf[64] = "EMPTY";
-            if (notif.best_bid.has_value()) {
-                snprintf(bid_buf, sizeof(bid_buf), "%.2f @ %.4f",
-                    notif.best_bid->price.to_f64(), notif.best_bid->qty.value);
-            }
-            if (notif.best_ask.has_value()) {
-                snprintf(ask_buf, sizeof(ask_buf), "%.2f @ %.4f",
-                    notif.best_ask->price.to_f64(), notif.best_ask->qty.value);
-            }
-            printf("[strategy] seq=%-6lu ts=%lu | best_bid: %-22s | best_ask: %-22s | lat=%luns\n",
-                notif.seq, notif.update_timestamp, bid_buf, ask_buf, latency_ns);
+        size_t n = queue.wait_ready(closed);
+        if (n == 0) break;
+
+        for (size_t i = 0; i < n; ++i) {
+            on_notification(queue.front(i), Clock::now_ns(), stats, log_enabled, inst, work_ns);
+        }
+        queue.pop_commit(n);
+    }
+
+    return stats;
+}
+
+/// Conflating variant: only ever processes the freshest top of book.
+/// Blocks until closed flag is set and the last value has been read.
+inline StrategyStats run_strategy(
+    ConflatingSlot<BookNotification>& latest,
+    std::atomic<bool>& closed,
+    bool log_enabled,
+    const Instrument& inst = Instrument::btc_usdt(),
+    uint64_t work_ns = 0)
+{
+    StrategyStats stats;
+    BookNotification notif;
+
+    while (latest.read(notif, closed)) {
+        on_notification(notif, Clock::now_ns(), stats, log_enabled, inst, work_ns);
+    }
+    stats.conflated = latest.conflated();
+
+    return stats;
+}
+
+/// Broadcast variant: consumer `id` of a ring shared with other strategies
+/// (and a recorder). Reads in place and commits each run with one store.
+template <size_t Cap>
+StrategyStats run_strategy(
+    BroadcastRing<BookNotification, Cap>& ring,
+    uint32_t id,
+    std::atomic<bool>& closed,
+    bool log_enabled,
+    const Instrument& inst = Instrument::btc_usdt(),
+    uint64_t work_ns = 0)
+{
+    StrategyStats stats;
+
+    while (true) {
+        size_t n = ring.wait_ready(id, closed);
+        if (n == 0) break;
+
+        for (size_t i = 0; i < n; ++i) {
+            on_notification(ring.front(id, i), Clock::now_ns(), stats, log_enabled, inst, work_ns);
+        }
+        ring.commit(id, n);
+    }
+
+    return stats;
+}
+
+/// Recorder: consumer `id` of a broadcast ring, normally registered behind
+/// the strategies. Appends every notification to `journal` and measures
+/// how long after the engine sent it each one was recorded.
+template <size_t Cap>
+StrategyStats run_recorder(
+    BroadcastRing<BookNotification, Cap>& ring,
+    uint32_t id,
+    std::atomic<bool>& closed,
+    std::vector<BookNotification>& journal)
+{
+    StrategyStats stats;
+
+    while (true) {
+        size_t n = ring.wait_ready(id, closed);
+        if (n == 0) break;
+
+        for (size_t i = 0; i < n; ++i) {
+            const BookNotification& notif = ring.front(id, i);
+            journal.push_back(notif);
+            stats.record(Clock::now_ns() - notif.engine_send_ns);
         }
+        ring.commit(id, n);
     }
 
     return stats;
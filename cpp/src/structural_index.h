@@ -0,0 +1,150 @@
+#pragma once
+/// Structural scan of CSV text, 64 bytes at a time (simdjson-style stage 1).
+/// Each block is classified into comma / quote / newline bitmasks (bit i =
+/// byte i). Quoted regions are resolved with a prefix-XOR over the quote
+/// mask, carried across blocks, so commas inside a quoted field (the
+/// snapshot JSON arrays) drop out. The parser then walks field boundaries
+/// by bit iteration instead of testing every byte.
+///
+/// A raw newline always ends the line and resets the quote state: the feed
+/// never quotes a newline, and CsvStream / AsyncCsvReader cut lines at raw
+/// newlines too. A stray or unbalanced quote therefore only affects its own
+/// line instead of swallowing the rest of the file, and the index reports
+/// that line so the parser can drop it.
+///
+/// Block classifiers are policies: SimdBlockScanner uses AVX2 or SSE2 when
+/// the target has them, ScalarBlockScanner is the portable fallback (and
+/// the benchmark baseline). Both produce identical masks.
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/// Raw per-byte classification of one 64-byte block.
+struct BlockMasks {
+    uint64_t comma;
+    uint64_t quote;
+    uint64_t newline;
+};
+
+struct ScalarBlockScanner {
+    static constexpr const char* NAME = "scalar";
+
+    static BlockMasks classify(const char* p) {
+        BlockMasks m{0, 0, 0};
+        for (unsigned i = 0; i < 64; ++i) {
+            const uint64_t bit = 1ULL << i;
+            if (p[i] == ',')  m.comma   |= bit;
+            if (p[i] == '"')  m.quote   |= bit;
+            if (p[i] == '\n') m.newline |= bit;
+        }
+        return m;
+    }
+};
+
+#if defined(__AVX2__)
+struct SimdBlockScanner {
+    static constexpr const char* NAME = "AVX2";
+
+    static BlockMasks classify(const char* p) {
+        const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+        return {eq(lo, hi, ','), eq(lo, hi, '"'), eq(lo, hi, '\n')};
+    }
+
+private:
+    static uint64_t eq(__m256i lo, __m256i hi, char c) {
+        const __m256i v = _mm256_set1_epi8(c);
+        const uint32_t a = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, v)));
+        const uint32_t b = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, v)));
+        return a | (static_cast<uint64_t>(b) << 32);
+    }
+};
+#elif defined(__SSE2__)
+struct SimdBlockScanner {
+    static constexpr const char* NAME = "SSE2";
+
+    static BlockMasks classify(const char* p) {
+        __m128i v[4];
+        for (int i = 0; i < 4; ++i) {
+            v[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+        }
+        return {eq(v, ','), eq(v, '"'), eq(v, '\n')};
+    }
+
+private:
+    static uint64_t eq(const __m128i (&v)[4], char c) {
+        const __m128i s = _mm_set1_epi8(c);
+        uint64_t m = 0;
+        for (int i = 0; i < 4; ++i) {
+            m |= static_cast<uint64_t>(static_cast<uint16_t>(
+                     _mm_movemask_epi8(_mm_cmpeq_epi8(v[i], s)))) << (16 * i);
+        }
+        return m;
+    }
+};
+#else
+using SimdBlockScanner = ScalarBlockScanner;
+#endif
+
+/// Walks a buffer block by block and yields the structural (unquoted)
+/// comma masks and the newline masks. Carries quote state between blocks
+/// until the next newline.
+template <typename Scanner>
+class StructuralIndex {
+public:
+    static constexpr size_t BLOCK = 64;
+
+    /// Unquoted commas and every newline of one block. `unbalanced` marks
+    /// the newlines that ended a line with a quote still open.
+    struct Structurals {
+        uint64_t comma;
+        uint64_t newline;
+        uint64_t unbalanced;
+    };
+
+    /// Classify the block at `p`, which must have 64 readable bytes.
+    Structurals next(const char* p) {
+        const BlockMasks m = Scanner::classify(p);
+        // Bits from an opening quote up to (not including) its closing
+        // quote are set; the carry extends a quote left open last block.
+        uint64_t quoted = prefix_xor(m.quote) ^ in_quote_;
+        // A quote still open at a newline is closed there: flip the parity
+        // of everything after it. One step per line, so ~1 per block.
+        for (uint64_t nl = m.newline; nl; nl &= nl - 1) {
+            const unsigned i = static_cast<unsigned>(std::countr_zero(nl));
+            const uint64_t after = (~0ULL << i) << 1;
+            quoted ^= after & (0 - ((quoted >> i) & 1));
+        }
+        // A newline in the last byte leaves nothing open for the next block.
+        in_quote_ = static_cast<uint64_t>(static_cast<int64_t>(quoted & ~m.newline) >> 63);
+        return {m.comma & ~quoted, m.newline, m.newline & quoted};
+    }
+
+    /// True if a quote is open at the end of the last block (a final line
+    /// without a newline is then unbalanced).
+    bool in_quote() const { return in_quote_ != 0; }
+
+    /// Running XOR from bit 0 up: bit i is the parity of quotes in [0, i].
+    static uint64_t prefix_xor(uint64_t x) {
+#if defined(__PCLMUL__)
+        const __m128i r = _mm_clmulepi64_si128(
+            _mm_set_epi64x(0, static_cast<int64_t>(x)), _mm_set1_epi8(-1), 0);
+        return static_cast<uint64_t>(_mm_cvtsi128_si64(r));
+#else
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+#endif
+    }
+
+private:
+    uint64_t in_quote_ = 0; // all ones while inside a quoted field
+};
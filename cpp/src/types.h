@@ -3,24 +3,19 @@
 /// All types designed to be small, trivially copyable, and cache-friendly.
 
 #include <cstdint>
-#include <cmath>
 #include <vector>
 #include <optional>
+#include <span>
+#include <type_traits>
 
-/// Fixed-point price: price * 100 stored as u64.
-/// Avoids floating-point comparison issues entirely.
+/// Fixed-point price: an integer number of the instrument's ticks
+/// (see Instrument). Avoids floating-point comparison issues entirely.
 struct Price {
     uint64_t raw;
 
     Price() : raw(0) {}
     explicit Price(uint64_t r) : raw(r) {}
 
-    static Price from_f64(double p) {
-        return Price(static_cast<uint64_t>(p * 100.0 + 0.5));
-    }
-
-    double to_f64() const { return static_cast<double>(raw) / 100.0; }
-
     bool operator==(Price o) const { return raw == o.raw; }
     bool operator!=(Price o) const { return raw != o.raw; }
     bool operator<(Price o) const { return raw < o.raw; }
@@ -29,20 +24,27 @@ struct Price {
     bool operator>=(Price o) const { return raw >= o.raw; }
 };
 
-/// Quantity stored as raw double.
+/// Quantity as an integer lot count. The lot size is per instrument
+/// (Instrument::qty_decimals), so the book is integer-only and aggregate
+/// depth sums are exact.
 struct Qty {
-    double value;
+    uint64_t lots;
 
-    Qty() : value(0.0) {}
-    explicit Qty(double v) : value(v) {}
+    Qty() : lots(0) {}
+    explicit Qty(uint64_t l) : lots(l) {}
 
-    bool is_zero() const { return value <= 1e-15; }
+    bool is_zero() const { return lots == 0; }
+
+    bool operator==(Qty o) const { return lots == o.lots; }
+    bool operator!=(Qty o) const { return lots != o.lots; }
 };
 
 /// A single price level.
 struct Level {
     Price price;
     Qty   qty;
+
+    bool operator==(const Level&) const = default;
 };
 
 enum class Side : uint8_t { Bid = 0, Ask = 1 };
@@ -50,17 +52,56 @@ enum class Side : uint8_t { Bid = 0, Ask = 1 };
 using Timestamp = uint64_t;
 
 /// An orderbook update — snapshot or incremental.
+/// Compact POD: a snapshot's levels live in the owning UpdateLog's level
+/// arena (bids then asks) and are referenced by offset and counts, so the
+/// update stream is one flat, cache-friendly array. Every byte belongs to
+/// a field (no padding), so `Update u{}` fully zeroes a record and raw
+/// captures are byte-deterministic.
 struct Update {
     enum class Type : uint8_t { Snapshot, Incremental };
 
-    Type      type;
     Timestamp timestamp;
-    Side      side;       // only for incremental
-    Level     level;      // only for incremental
+    Level     level;          // only for incremental
+    uint32_t  levels_begin;   // only for snapshot: first bid in the arena
+    uint32_t  bid_count;      // only for snapshot
+    uint32_t  ask_count;      // only for snapshot
+    Type      type;
+    Side      side;           // only for incremental
+    uint16_t  reserved;       // always zero; fills what would be padding
 
-    // only for snapshot
-    std::vector<Level> bids;
-    std::vector<Level> asks;
+    bool operator==(const Update&) const = default;
+
+    std::span<const Level> bids(std::span<const Level> arena) const {
+        return arena.subspan(levels_begin, bid_count);
+    }
+    std::span<const Level> asks(std::span<const Level> arena) const {
+        return arena.subspan(size_t{levels_begin} + bid_count, ask_count);
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<Update>);
+static_assert(std::has_unique_object_representations_v<Update>, "Update must have no padding");
+
+/// A parsed update stream: the updates plus the single arena that holds
+/// every snapshot's levels.
+struct UpdateLog {
+    /// Snapshots address the arena with 32-bit offsets, so a log holds at
+    /// most this many levels; the parsers fail rather than wrap past it.
+    static constexpr size_t MAX_LEVELS = UINT32_MAX;
+
+    std::vector<Update> updates;
+    std::vector<Level>  levels;
+
+    size_t size() const { return updates.size(); }
+    bool empty() const { return updates.empty(); }
+
+    void reserve(size_t n) { updates.reserve(n); }
+    void push(const Update& u) { updates.push_back(u); }
+    bool operator==(const UpdateLog&) const = default;
+    void clear() {
+        updates.clear();
+        levels.clear();
+    }
 };
 
 /// Notification sent from engine to strategy.
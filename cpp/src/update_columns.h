@@ -0,0 +1,74 @@
+#pragma once
+/// Struct-of-arrays update store for long historical replays.
+/// Each field of Update lives in its own array, so a replay streams only the
+/// columns it touches (type, side, price, qty — not timestamps) instead of
+/// dragging whole 40-byte records through the cache. Snapshot rows point, in
+/// order, into a side table of level ranges over one shared level arena.
+
+#include <vector>
+#include "types.h"
+
+struct UpdateColumns {
+    /// Level range of one snapshot row within `levels` (bids then asks).
+    struct SnapshotRef {
+        uint32_t levels_begin;
+        uint32_t bid_count;
+        uint32_t ask_count;
+    };
+
+    std::vector<Update::Type> types;
+    std::vector<Timestamp>    timestamps;
+    std::vector<Side>         sides;      // incremental rows only meaningful
+    std::vector<Price>        prices;     // incremental rows only meaningful
+    std::vector<Qty>          qtys;       // incremental rows only meaningful
+    std::vector<SnapshotRef>  snapshots;  // one per snapshot row, in row order
+    std::vector<Level>        levels;
+
+    size_t size() const { return types.size(); }
+    bool empty() const { return types.empty(); }
+
+    void reserve(size_t n) {
+        types.reserve(n);
+        timestamps.reserve(n);
+        sides.reserve(n);
+        prices.reserve(n);
+        qtys.reserve(n);
+    }
+
+    /// Append one row. Snapshot levels must already be in `levels`.
+    void push(const Update& u) {
+        types.push_back(u.type);
+        timestamps.push_back(u.timestamp);
+        sides.push_back(u.side);
+        prices.push_back(u.level.price);
+        qtys.push_back(u.level.qty);
+        if (u.type == Update::Type::Snapshot) {
+            snapshots.push_back(SnapshotRef{u.levels_begin, u.bid_count, u.ask_count});
+        }
+    }
+
+    static UpdateColumns from_log(const UpdateLog& log) {
+        UpdateColumns cols;
+        cols.reserve(log.size());
+        cols.levels = log.levels;
+        for (const auto& u : log.updates) cols.push(u);
+        return cols;
+    }
+};
+
+/// Apply every row to `book` in order, reading only the columns needed.
+template <typename Book>
+void replay_columns(Book& book, const UpdateColumns& cols) {
+    std::span<const Level> arena(cols.levels);
+    const size_t n = cols.size();
+    size_t snap = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (cols.types[i] == Update::Type::Incremental) {
+            book.apply_incremental(cols.sides[i], Level{cols.prices[i], cols.qtys[i]});
+        } else {
+            const auto& s = cols.snapshots[snap++];
+            book.apply_snapshot(arena.subspan(s.levels_begin, s.bid_count),
+                                arena.subspan(s.levels_begin + s.bid_count, s.ask_count));
+        }
+    }
+}
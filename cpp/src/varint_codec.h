@@ -0,0 +1,174 @@
+#pragma once
+/// Delta + varint encoding of an update stream (capture encoding 1).
+/// Per update:
+///   varint  zigzag(timestamp - previous timestamp) << 2 | side << 1 | type
+///   incremental:
+///     varint  zigzag(price - previous price on the same side), in ticks
+///     varint  qty lots
+///   snapshot:
+///     varint  bid count, varint ask count
+///     per level: zigzag price delta (chained within the side), qty varint
+/// Deltas are small near the touch, so a typical incremental takes 4-8
+/// bytes against 40 raw. Timestamp deltas must stay under 2^61.
+///
+/// Decoding reads varints a word at a time: the terminating byte is found
+/// with one tzcnt and the 7-bit groups are gathered with pext (BMI2), or a
+/// short shift loop without it. The byte loop is only used within eight
+/// bytes of the end of the readable buffer.
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+#include "types.h"
+
+class DeltaVarintCodec {
+public:
+    /// Append the encoding of `feed` to `out`.
+    static void encode(const UpdateLog& feed, std::vector<uint8_t>& out) {
+        uint64_t last_ts = 0;
+        uint64_t last_price[2] = {0, 0};
+        for (const Update& u : feed.updates) {
+            const uint64_t head = zigzag(static_cast<int64_t>(u.timestamp - last_ts)) << 2 |
+                                  static_cast<uint64_t>(u.side) << 1 |
+                                  static_cast<uint64_t>(u.type);
+            put_varint(out, head);
+            last_ts = u.timestamp;
+
+            if (u.type == Update::Type::Incremental) {
+                put_level(out, u.level, last_price[static_cast<size_t>(u.side)]);
+                continue;
+            }
+            put_varint(out, u.bid_count);
+            put_varint(out, u.ask_count);
+            for (const Level& l : u.bids(feed.levels)) put_level(out, l, last_price[0]);
+            for (const Level& l : u.asks(feed.levels)) put_level(out, l, last_price[1]);
+        }
+    }
+
+    /// Decode `count` updates from [p, end) into `out` (appending to its
+    /// arena). Bytes up to `readable_end` (>= end) may be read but are not
+    /// decoded; the capture writer pads the stream so the word-at-a-time
+    /// path covers it. Returns false if the stream is truncated or corrupt.
+    static bool decode(const uint8_t* p, const uint8_t* end, const uint8_t* readable_end,
+                       uint64_t count, UpdateLog& out) {
+        Reader in{p, end, readable_end};
+        uint64_t ts = 0;
+        uint64_t last_price[2] = {0, 0};
+        out.updates.reserve(out.updates.size() + count);
+
+        for (uint64_t n = 0; n < count; ++n) {
+            uint64_t head;
+            if (!in.varint(head)) return false;
+            ts += static_cast<uint64_t>(unzigzag(head >> 2));
+
+            Update u{};
+            u.timestamp = ts;
+            u.type = static_cast<Update::Type>(head & 1);
+            u.side = static_cast<Side>((head >> 1) & 1);
+            if (u.type == Update::Type::Incremental) {
+                if (!in.level(u.level, last_price[static_cast<size_t>(u.side)])) return false;
+            } else {
+                uint64_t bids, asks;
+                if (!in.varint(bids) || !in.varint(asks)) return false;
+                // Each level takes at least two bytes: reject counts the
+                // remaining input cannot hold before sizing the arena.
+                const uint64_t room = static_cast<uint64_t>(in.end - in.p) / 2;
+                if (bids > room || asks > room - bids) return false;
+                if (out.levels.size() + bids + asks > UpdateLog::MAX_LEVELS) return false;
+                u.levels_begin = static_cast<uint32_t>(out.levels.size());
+                u.bid_count = static_cast<uint32_t>(bids);
+                u.ask_count = static_cast<uint32_t>(asks);
+                out.levels.resize(out.levels.size() + bids + asks);
+                Level* l = out.levels.data() + u.levels_begin;
+                for (uint64_t i = 0; i < bids; ++i) {
+                    if (!in.level(*l++, last_price[0])) return false;
+                }
+                for (uint64_t i = 0; i < asks; ++i) {
+                    if (!in.level(*l++, last_price[1])) return false;
+                }
+            }
+            out.updates.push_back(u);
+        }
+        return true;
+    }
+
+    static uint64_t zigzag(int64_t v) {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    }
+
+    static int64_t unzigzag(uint64_t v) {
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+
+private:
+    static void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    static void put_level(std::vector<uint8_t>& out, const Level& l, uint64_t& last_price) {
+        put_varint(out, zigzag(static_cast<int64_t>(l.price.raw - last_price)));
+        put_varint(out, l.qty.lots);
+        last_price = l.price.raw;
+    }
+
+    struct Reader {
+        const uint8_t* p;
+        const uint8_t* end;
+        const uint8_t* readable_end;
+
+        bool varint(uint64_t& v) {
+            if (readable_end - p >= 8) {
+                uint64_t word;
+                std::memcpy(&word, p, 8);
+                const uint64_t stops = ~word & 0x8080808080808080ULL;
+                if (stops) {
+                    const unsigned bits = static_cast<unsigned>(std::countr_zero(stops)) + 1;
+                    const unsigned len = bits >> 3;
+                    const uint64_t mask = (bits == 64) ? ~0ULL : (1ULL << bits) - 1;
+                    v = gather7(word & mask);
+                    p += len;
+                    return p <= end;
+                }
+            }
+            return varint_slow(v);
+        }
+
+        bool level(Level& l, uint64_t& last_price) {
+            uint64_t delta, lots;
+            if (!varint(delta) || !varint(lots)) return false;
+            last_price += static_cast<uint64_t>(unzigzag(delta));
+            l = Level{Price(last_price), Qty(lots)};
+            return true;
+        }
+
+        /// Byte loop for varints longer than eight bytes or at the buffer end.
+        bool varint_slow(uint64_t& v) {
+            v = 0;
+            for (unsigned shift = 0; shift < 64 && p < end; shift += 7) {
+                const uint8_t b = *p++;
+                v |= static_cast<uint64_t>(b & 0x7F) << shift;
+                if (!(b & 0x80)) return true;
+            }
+            return false;
+        }
+
+        /// Concatenate the low seven bits of each byte, least significant first.
+        static uint64_t gather7(uint64_t word) {
+#if defined(__BMI2__)
+            return _pext_u64(word, 0x7F7F7F7F7F7F7F7FULL);
+#else
+            uint64_t v = 0;
+            for (unsigned i = 0; i < 8; ++i) v |= ((word >> (8 * i)) & 0x7F) << (7 * i);
+            return v;
+#endif
+        }
+    };
+};
@@ -0,0 +1,64 @@
+#pragma once
+/// Sorted-vector level store.
+/// Each side is one contiguous std::vector<Level> ordered so the best price
+/// is at the back: bids ascending, asks descending. Most updates land within
+/// a few levels of the touch, so lookups scan a short run from the back
+/// before falling back to binary search, and inserts/erases shift only the
+/// handful of elements between the hit and the touch.
+
+#include <algorithm>
+#include <vector>
+#include "types.h"
+#include "orderbook.h"
+
+template <Side S>
+class VectorLevels {
+public:
+    /// Levels checked linearly from the touch before binary search.
+    static constexpr size_t LINEAR_SCAN = 8;
+
+    void clear() { levels_.clear(); }
+
+    void set(Price price, Qty qty) {
+        auto it = find(price);
+        if (it != levels_.end() && it->price == price) {
+            it->qty = qty;
+        } else {
+            levels_.insert(it, Level{price, qty});
+        }
+    }
+
+    void erase(Price price) {
+        auto it = find(price);
+        if (it != levels_.end() && it->price == price) levels_.erase(it);
+    }
+
+    std::optional<Level> best() const {
+        if (levels_.empty()) return std::nullopt;
+        return levels_.back();
+    }
+
+    size_t size() const { return levels_.size(); }
+
+private:
+    std::vector<Level> levels_;
+
+    /// True if `a` is further from the touch than `b` (sits before it).
+    static bool worse(Price a, Price b) {
+        return S == Side::Bid ? a < b : a > b;
+    }
+
+    /// First level that is not worse than `price`: the level itself if
+    /// present, otherwise the insertion point.
+    std::vector<Level>::iterator find(Price price) {
+        size_t i = levels_.size();
+        const size_t stop = (i > LINEAR_SCAN) ? i - LINEAR_SCAN : 0;
+        while (i > stop && !worse(levels_[i - 1].price, price)) --i;
+        if (i > stop || stop == 0) return levels_.begin() + i;
+
+        return std::lower_bound(levels_.begin(), levels_.begin() + stop, price,
+            [](const Level& l, Price p) { return worse(l.price, p); });
+    }
+};
+
+using VectorOrderbook = BasicOrderbook<VectorLevels>;
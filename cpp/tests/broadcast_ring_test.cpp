@@ -0,0 +1,127 @@
+/// BroadcastRing tests: invalid dependencies are rejected, a consumer that
+/// depends on others only sees what all of them have finished with, and
+/// two strategies plus a recorder behind both, on threads and wrapping
+/// the ring many times, each read every element in order without the
+/// recorder passing either strategy.
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include "broadcast_ring.h"
+#include "check.h"
+
+using Ring = BroadcastRing<uint64_t, 8>;
+
+static void test_add_consumer_rejects_bad_deps() {
+    Ring ring;
+    const uint32_t none[] = {0};
+    CHECK(ring.add_consumer(none) == -1); // no consumer 0 yet
+    CHECK(ring.consumer_count() == 0);
+
+    CHECK(ring.add_consumer() == 0);
+    const uint32_t later[] = {0, 1};
+    CHECK(ring.add_consumer(later) == -1); // 1 is not an earlier consumer
+    const uint32_t too_many[] = {0, 0};
+    CHECK(ring.add_consumer(too_many) == -1);
+    CHECK(ring.consumer_count() == 1);
+
+    const uint32_t first[] = {0};
+    CHECK(ring.add_consumer(first) == 1);
+    for (uint32_t i = 2; i < Ring::MAX_CONSUMERS; ++i) CHECK(ring.add_consumer() == static_cast<int>(i));
+    CHECK(ring.add_consumer() == -1);
+}
+
+/// Single thread, stepped by hand: the recorder's view is the minimum of
+/// the strategies' cursors.
+static void test_dependency_gating() {
+    Ring ring;
+    const int a = ring.add_consumer();
+    const int b = ring.add_consumer();
+    const uint32_t both[] = {static_cast<uint32_t>(a), static_cast<uint32_t>(b)};
+    const int rec = ring.add_consumer(both);
+    CHECK(a == 0 && b == 1 && rec == 2);
+
+    for (uint64_t i = 0; i < 5; ++i) ring.emplace(i);
+    CHECK(ring.ready(a) == 5);
+    CHECK(ring.ready(b) == 5);
+    CHECK(ring.ready(rec) == 0);
+
+    ring.commit(a, 3);
+    CHECK(ring.ready(rec) == 0); // b has not moved
+    ring.commit(b, 1);
+    CHECK(ring.ready(rec) == 1);
+    CHECK(ring.front(rec) == 0);
+    ring.commit(rec, 1);
+    ring.commit(b, 4);
+    CHECK(ring.ready(rec) == 2); // now gated by a at 3
+    CHECK(ring.front(rec, 1) == 2);
+    ring.commit(rec, 2);
+
+    // Closed: strategies drain, then the recorder gets the rest and stops.
+    std::atomic<bool> closed{true};
+    CHECK(ring.wait_ready(a, closed) == 2);
+    CHECK(ring.front(a) == 3);
+    ring.commit(a, 2);
+    CHECK(ring.wait_ready(a, closed) == 0);
+    CHECK(ring.wait_ready(rec, closed) == 2);
+    ring.commit(rec, 2);
+    CHECK(ring.wait_ready(rec, closed) == 0);
+}
+
+static void test_threads_multi_stage() {
+    constexpr uint64_t COUNT = 20'000;
+    auto owned = std::make_unique<BroadcastRing<uint64_t, 256>>();
+    auto& ring = *owned;
+    const uint32_t strategies[] = {static_cast<uint32_t>(ring.add_consumer()),
+                                   static_cast<uint32_t>(ring.add_consumer())};
+    const int recorder = ring.add_consumer(strategies);
+    std::atomic<bool> closed{false};
+
+    // Elements each strategy has finished with, published before its commit.
+    std::atomic<uint64_t> done[2] = {0, 0};
+    uint64_t seen[3] = {0, 0, 0};
+    bool ordered[3] = {true, true, true};
+    bool behind = true;
+
+    auto strategy = [&](uint32_t k) {
+        const uint32_t id = strategies[k];
+        while (size_t n = ring.wait_ready(id, closed)) {
+            for (size_t i = 0; i < n; ++i) ordered[k] = ordered[k] && ring.front(id, i) == seen[k] + i;
+            seen[k] += n;
+            done[k].store(seen[k], std::memory_order_release);
+            ring.commit(id, n);
+        }
+    };
+    std::thread s0(strategy, 0), s1(strategy, 1);
+    std::thread rec([&]() {
+        const uint32_t id = static_cast<uint32_t>(recorder);
+        while (size_t n = ring.wait_ready(id, closed)) {
+            for (size_t i = 0; i < n; ++i) ordered[2] = ordered[2] && ring.front(id, i) == seen[2] + i;
+            seen[2] += n;
+            // Both strategies have committed at least this far.
+            behind = behind && done[0].load(std::memory_order_acquire) >= seen[2] &&
+                     done[1].load(std::memory_order_acquire) >= seen[2];
+            ring.commit(id, n);
+        }
+    });
+
+    for (uint64_t i = 0; i < COUNT; ++i) ring.emplace(i);
+    closed.store(true, std::memory_order_release);
+    s0.join();
+    s1.join();
+    rec.join();
+
+    for (int k = 0; k < 3; ++k) {
+        CHECK(seen[k] == COUNT);
+        CHECK(ordered[k]);
+    }
+    CHECK(behind);
+}
+
+int main() {
+    test_add_consumer_rejects_bad_deps();
+    test_dependency_gating();
+    test_threads_multi_stage();
+    return finish("broadcast_ring_test");
+}
@@ -0,0 +1,150 @@
+/// BTreeLevels and NodePool tests: released nodes are recycled without new
+/// chunks, sequential inserts split leaves and inner nodes up to a deep
+/// tree, draining it (from either end or from the middle) unlinks empty
+/// nodes and collapses the root, and random grow/shrink cycles give the
+/// same book as the std::map store.
+
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+#include "btree_levels.h"
+#include "node_pool.h"
+#include "check.h"
+
+static bool same_best(const std::optional<Level>& a, const std::optional<Level>& b) {
+    if (!a || !b) return !a && !b;
+    return a->price == b->price && a->qty == b->qty;
+}
+
+static void test_node_pool_recycles() {
+    struct alignas(64) Node {
+        uint64_t value = 7;
+    };
+    NodePool<Node, 4> pool;
+
+    std::vector<Node*> first;
+    for (int i = 0; i < 10; ++i) first.push_back(pool.acquire());
+    std::set<Node*> distinct(first.begin(), first.end());
+    CHECK(distinct.size() == first.size());
+    for (Node* n : first) {
+        CHECK(reinterpret_cast<uintptr_t>(n) % alignof(Node) == 0);
+        CHECK(n->value == 7);
+        n->value = 0;
+    }
+
+    for (Node* n : first) pool.release(n);
+    // The 12 slots carved so far cover the next 10 acquires: every node
+    // comes back from the free list, default-constructed again.
+    for (int i = 0; i < 10; ++i) {
+        Node* n = pool.acquire();
+        CHECK(distinct.count(n) == 1);
+        CHECK(n->value == 7);
+    }
+}
+
+/// Enough keys for several levels of inner nodes.
+static constexpr uint64_t KEYS = 5000;
+
+template <Side S>
+static void test_splits_and_drain_from_best() {
+    BTreeLevels<S> tree;
+    MapLevels<S> map;
+    for (uint64_t k = 1; k <= KEYS; ++k) {
+        tree.set(Price(k), Qty(k));
+        map.set(Price(k), Qty(k));
+        CHECK(same_best(tree.best(), map.best()));
+    }
+    CHECK(tree.size() == KEYS);
+
+    // Overwrites change the value in place, not the size.
+    tree.set(Price(KEYS / 2), Qty(1));
+    map.set(Price(KEYS / 2), Qty(1));
+    CHECK(tree.size() == KEYS);
+
+    // Erase from the touch inwards: each end leaf empties in turn.
+    for (uint64_t i = 0; i < KEYS; ++i) {
+        const uint64_t k = S == Side::Ask ? i + 1 : KEYS - i;
+        tree.erase(Price(k));
+        map.erase(Price(k));
+        CHECK(tree.size() == map.size());
+        CHECK(same_best(tree.best(), map.best()));
+        if (check_failures) return;
+    }
+    CHECK(!tree.best());
+
+    // The collapsed tree is usable again.
+    tree.set(Price(42), Qty(3));
+    CHECK(tree.size() == 1);
+    CHECK(same_best(tree.best(), Level{Price(42), Qty(3)}));
+}
+
+template <Side S>
+static void test_erase_middle_then_edges() {
+    BTreeLevels<S> tree;
+    for (uint64_t k = 1; k <= KEYS; ++k) tree.set(Price(k), Qty(1));
+
+    // Whole leaves and inner nodes in the middle empty and are unlinked;
+    // both ends stay reachable through the leaf list.
+    for (uint64_t k = 1000; k < 4000; ++k) tree.erase(Price(k));
+    CHECK(tree.size() == KEYS - 3000);
+    CHECK(tree.best()->price == Price(S == Side::Ask ? 1 : KEYS));
+
+    // Erasing a missing key is a no-op.
+    tree.erase(Price(2000));
+    CHECK(tree.size() == KEYS - 3000);
+
+    // Drop the best side's block entirely: the best jumps across the gap.
+    if constexpr (S == Side::Ask) {
+        for (uint64_t k = 1; k < 1000; ++k) tree.erase(Price(k));
+        CHECK(tree.best()->price == Price(4000));
+    } else {
+        for (uint64_t k = 4000; k <= KEYS; ++k) tree.erase(Price(k));
+        CHECK(tree.best()->price == Price(999));
+    }
+
+    tree.clear();
+    CHECK(tree.size() == 0);
+    CHECK(!tree.best());
+    tree.set(Price(7), Qty(7));
+    CHECK(tree.best()->price == Price(7));
+}
+
+/// Alternating phases that mostly insert then mostly erase, so the tree
+/// repeatedly grows several levels and shrinks back, checked against
+/// MapLevels after every step.
+template <Side S>
+static void test_matches_map_store() {
+    BTreeLevels<S> tree;
+    MapLevels<S> map;
+    std::mt19937_64 rng(7);
+
+    for (int phase = 0; phase < 8; ++phase) {
+        const uint64_t insert_pct = phase % 2 == 0 ? 75 : 25;
+        for (int step = 0; step < 20'000; ++step) {
+            const Price price(1 + rng() % 20'000);
+            if (rng() % 100 < insert_pct) {
+                const Qty qty(1 + rng() % 100);
+                tree.set(price, qty);
+                map.set(price, qty);
+            } else {
+                tree.erase(price);
+                map.erase(price);
+            }
+            CHECK(tree.size() == map.size());
+            CHECK(same_best(tree.best(), map.best()));
+            if (check_failures) return;
+        }
+    }
+}
+
+int main() {
+    test_node_pool_recycles();
+    test_splits_and_drain_from_best<Side::Bid>();
+    test_splits_and_drain_from_best<Side::Ask>();
+    test_erase_middle_then_edges<Side::Bid>();
+    test_erase_middle_then_edges<Side::Ask>();
+    test_matches_map_store<Side::Bid>();
+    test_matches_map_store<Side::Ask>();
+    return finish("btree_levels_test");
+}
@@ -0,0 +1,26 @@
+#pragma once
+/// Minimal check macro for the C++ tests (built with -fno-exceptions, so no
+/// framework). A failed CHECK prints its location and is counted; main()
+/// returns finish("name") as the exit code.
+
+#include <cstdio>
+
+inline int check_failures = 0;
+
+#define CHECK(cond)                                                                \
+    do {                                                                           \
+        if (!(cond)) {                                                             \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++check_failures;                                                      \
+        }                                                                          \
+    } while (0)
+
+/// Report the result of test binary `name`; returns its exit code.
+inline int finish(const char* name) {
+    if (check_failures) {
+        fprintf(stderr, "%s: %d check(s) failed\n", name, check_failures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
@@ -0,0 +1,89 @@
+/// ConflatingSlot tests: a read returns only the latest value and counts
+/// the ones overwritten before it, nothing is returned twice, a value
+/// published before close is still picked up, and a consumer thread
+/// reading a multi-word value under a fast producer never sees a torn or
+/// older value and always ends on the last one.
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "conflating_slot.h"
+#include "check.h"
+
+/// Several words that must always agree, so a torn read is detectable.
+struct Stamp {
+    uint64_t seq;
+    uint64_t twice;
+    uint64_t inverted;
+    uint64_t pad[5];
+
+    static Stamp of(uint64_t seq) {
+        Stamp s{seq, seq * 2, ~seq, {}};
+        for (uint64_t& p : s.pad) p = seq + 1;
+        return s;
+    }
+    bool consistent() const {
+        if (twice != seq * 2 || inverted != ~seq) return false;
+        for (uint64_t p : pad) if (p != seq + 1) return false;
+        return true;
+    }
+};
+
+static void test_latest_value_and_conflation() {
+    ConflatingSlot<Stamp> slot;
+    Stamp out{};
+    CHECK(!slot.try_read(out));
+    CHECK(slot.published() == 0);
+
+    slot.publish(Stamp::of(1));
+    CHECK(slot.try_read(out));
+    CHECK(out.seq == 1);
+    CHECK(slot.conflated() == 0);
+    CHECK(!slot.try_read(out)); // nothing new
+
+    for (uint64_t i = 2; i <= 5; ++i) slot.publish(Stamp::of(i));
+    CHECK(slot.published() == 5);
+    CHECK(slot.try_read(out));
+    CHECK(out.seq == 5 && out.consistent());
+    CHECK(slot.conflated() == 3);
+
+    // Closed: a final value is still read once, then read() reports done.
+    std::atomic<bool> closed{true};
+    slot.publish(Stamp::of(6));
+    CHECK(slot.read(out, closed));
+    CHECK(out.seq == 6);
+    CHECK(!slot.read(out, closed));
+    CHECK(slot.conflated() == 3);
+}
+
+static void test_threads_never_torn() {
+    constexpr uint64_t COUNT = 500'000;
+    ConflatingSlot<Stamp> slot;
+    std::atomic<bool> closed{false};
+    uint64_t reads = 0, last = 0;
+    bool consistent = true, increasing = true;
+
+    std::thread consumer([&]() {
+        Stamp s{};
+        while (slot.read(s, closed)) {
+            consistent = consistent && s.consistent();
+            increasing = increasing && s.seq > last;
+            last = s.seq;
+            ++reads;
+        }
+    });
+    for (uint64_t i = 1; i <= COUNT; ++i) slot.publish(Stamp::of(i));
+    closed.store(true, std::memory_order_release);
+    consumer.join();
+
+    CHECK(consistent);
+    CHECK(increasing);
+    CHECK(last == COUNT);
+    CHECK(reads + slot.conflated() == COUNT);
+}
+
+int main() {
+    test_latest_value_and_conflation();
+    test_threads_never_torn();
+    return finish("conflating_slot_test");
+}
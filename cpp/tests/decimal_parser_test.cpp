@@ -0,0 +1,52 @@
+/// DecimalParser tests: the SWAR paths (one chunk up to eight bytes, split
+/// at the '.' up to sixteen) agree with the byte-at-a-time reference.
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include "decimal_parser.h"
+#include "check.h"
+
+static uint64_t fixed(const std::string& s, uint32_t decimals) {
+    return DecimalParser::parse_fixed(s.data(), s.data() + s.size(), decimals);
+}
+
+static uint64_t scalar(const std::string& s, uint32_t decimals) {
+    return DecimalParser::parse_fixed_scalar(s.data(), s.data() + s.size(), decimals);
+}
+
+static void test_known_values() {
+    CHECK(fixed("99998.24", 2) == 9999824);
+    CHECK(fixed("100009.36", 2) == 10000936);
+    CHECK(fixed("0.527", 8) == 52'700'000);
+    CHECK(fixed("3.1404", 8) == 314'040'000);
+    CHECK(fixed("1234567.12345678", 8) == 123'456'712'345'678);
+    CHECK(fixed("100009.365", 2) == 10000937); // rounds half up
+    CHECK(fixed("100000", 2) == 10000000);
+    CHECK(fixed(".5", 2) == 50);
+    CHECK(fixed("7.", 2) == 700);
+}
+
+/// Every length from 1 to 17 bytes and every '.' position, with up to
+/// eight fraction digits, against the scalar reference.
+static void test_matches_scalar() {
+    std::mt19937_64 rng(11);
+    for (size_t len = 1; len <= 17; ++len) {
+        for (size_t dot = 0; dot <= len; ++dot) {
+            for (uint32_t decimals : {0u, 2u, 4u, 8u}) {
+                for (int rep = 0; rep < 20; ++rep) {
+                    std::string s;
+                    for (size_t i = 0; i < len; ++i) s += static_cast<char>('0' + rng() % 10);
+                    if (dot < len) s[dot] = '.';
+                    CHECK(fixed(s, decimals) == scalar(s, decimals));
+                }
+            }
+        }
+    }
+}
+
+int main() {
+    test_known_values();
+    test_matches_scalar();
+    return finish("decimal_parser_test");
+}
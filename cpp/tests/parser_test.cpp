@@ -0,0 +1,173 @@
+/// CSV parser tests: malformed lines (unbalanced quotes, extra fields) are
+/// rejected without affecting their neighbours, prices off the tick grid
+/// are rejected rather than rounded, and every reader (whole buffer,
+/// streamed window, async read-ahead, parallel ranges) must produce the
+/// same updates.
+
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include "parser.h"
+#include "csv_stream.h"
+#include "async_reader.h"
+#include "parallel_parser.h"
+#include "check.h"
+
+static const char* HEADER = "type,exchange,symbol,timestamp,side,bids,asks,price,size\n";
+
+static UpdateLog parse(const std::string& body) {
+    UpdateLog out;
+    CsvReader::parse_buffer(body.data(), body.size(), Instrument::btc_usdt(), out);
+    return out;
+}
+
+/// Write header + body to a temp file; returns its path.
+static std::string write_temp(const std::string& body) {
+    char path[] = "/tmp/parser_test_XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return {};
+    }
+    const std::string text = HEADER + body;
+    const bool ok = write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+    close(fd);
+    if (!ok) perror("write");
+    return path;
+}
+
+static void test_stray_quote_stays_on_its_line() {
+    const std::string body =
+        "incremental,binance,BTC/USDT,1,bid,,,100.00,1.0\n"
+        "incremental,binance,\"BTC/USDT,2,bid,,,101.00,2.0\n"
+        "incremental,binance,BTC/USDT,3,ask,,,102.00,3.0\n"
+        "snapshot,binance,BTC/USDT,4,,\"[[99.00, 1.0]]\",\"[[103.00, 2.0]]\",,\n";
+    const UpdateLog log = parse(body);
+
+    // The unbalanced line is dropped; the lines after it parse normally.
+    CHECK(log.size() == 3);
+    if (log.size() != 3) return;
+    CHECK(log.updates[0].timestamp == 1);
+    CHECK(log.updates[1].timestamp == 3);
+    CHECK(log.updates[1].side == Side::Ask);
+    CHECK(log.updates[1].level.price == Price(10200));
+    CHECK(log.updates[2].type == Update::Type::Snapshot);
+    CHECK(log.updates[2].timestamp == 4);
+    CHECK(log.updates[2].bid_count == 1 && log.updates[2].ask_count == 1);
+}
+
+static void test_unbalanced_last_line() {
+    const UpdateLog log = parse(
+        "incremental,binance,BTC/USDT,1,bid,,,100.00,1.0\n"
+        "incremental,binance,BTC/USDT,2,\"bid,,,101.00,2.0");
+    CHECK(log.size() == 1);
+}
+
+static void test_extra_fields_rejected() {
+    const UpdateLog log = parse(
+        "incremental,binance,BTC/USDT,1,bid,,,100.00,1.0\n"
+        "incremental,binance,BTC/USDT,2,bid,,,101.00,2.0,extra\n"
+        "snapshot,binance,BTC/USDT,3,,\"[[99.00, 1.0]]\",\"[[103.00, 2.0]]\",,,\n"
+        "incremental,binance,BTC/USDT,4,ask,,,102.00,3.0\n");
+    // A tenth field is rejected rather than folded into the ninth.
+    CHECK(log.size() == 2);
+    if (log.size() != 2) return;
+    CHECK(log.updates[0].timestamp == 1);
+    CHECK(log.updates[1].timestamp == 4);
+}
+
+static void test_quote_state_resets_across_blocks() {
+    // Open a quote early in a long line so the newline that ends it falls
+    // in a later 64-byte block than the quote.
+    std::string body = "incremental,\"" + std::string(150, 'x') + ",1,bid,,,100.00,1.0\n";
+    for (int i = 0; i < 4; ++i) body += "incremental,binance,BTC/USDT,7,bid,,,100.00,1.0\n";
+    const UpdateLog log = parse(body);
+    CHECK(log.size() == 4);
+    for (const Update& u : log.updates) CHECK(u.timestamp == 7);
+}
+
+static void test_off_tick_prices_rejected() {
+    const Instrument five_cents{2, 5, 8}; // 0.05 ticks
+    const std::string body =
+        "incremental,binance,BTC/USDT,1,bid,,,100.05,1.0\n"
+        "incremental,binance,BTC/USDT,2,bid,,,100.07,1.0\n"
+        "snapshot,binance,BTC/USDT,3,,\"[[100.00, 1.0], [99.97, 2.0], [99.95, 3.0]]\",\"[[100.11, 4.0]]\",,\n";
+    UpdateLog log;
+    CsvReader::parse_buffer(body.data(), body.size(), five_cents, log);
+
+    // The off-tick incremental is dropped, not rounded to 100.05.
+    CHECK(log.size() == 2);
+    if (log.size() != 2) return;
+    CHECK(log.updates[0].timestamp == 1);
+    CHECK(log.updates[0].level.price == Price(2001));
+
+    // Off-tick snapshot levels are dropped; the rest of the snapshot stays.
+    const Update& snap = log.updates[1];
+    CHECK(snap.bid_count == 2);
+    CHECK(snap.ask_count == 0);
+    if (snap.bid_count != 2) return;
+    CHECK(snap.bids(log.levels)[0].price == Price(2000));
+    CHECK(snap.bids(log.levels)[1].price == Price(1999));
+
+    std::vector<Level> scalar;
+    CHECK(CsvReader::parse_levels_json_scalar("[[100.00, 1.0], [99.97, 2.0], [99.95, 3.0]]", five_cents,
+                                              scalar) == 2);
+    CHECK(scalar.size() == 2 && scalar[1].price == Price(1999));
+}
+
+static void test_readers_agree_on_malformed_input() {
+    std::string line_block =
+        "incremental,binance,BTC/USDT,1,bid,,,100.00,1.0\n"
+        "incremental,binance,\"BTC/USDT,2,bid,,,101.00,2.0\n"
+        "snapshot,binance,BTC/USDT,3,,\"[[99.00, 1.0], [98.00, 2.0]]\",\"[[103.00, 2.0]]\",,\n"
+        "incremental,binance,BTC/USDT,4,ask,,,\"102.00,3.0\n";
+    // Large enough for several parallel ranges and stream windows.
+    std::string body;
+    while (body.size() < 4 * ParallelCsvReader::MIN_RANGE_BYTES) body += line_block;
+
+    const UpdateLog reference = parse(body);
+    CHECK(reference.size() == body.size() / line_block.size() * 2);
+
+    CHECK(ParallelCsvReader::parse_buffer(body.data(), body.size(), 4) == reference);
+
+    const std::string path = write_temp(body);
+    if (path.empty()) {
+        ++check_failures;
+        return;
+    }
+
+    UpdateLog streamed, batch;
+    CsvStream stream(path.c_str(), Instrument::btc_usdt(), 4096);
+    CHECK(stream.ok());
+    while (stream.next_batch(batch)) {
+        const auto base = static_cast<uint32_t>(streamed.levels.size());
+        for (Update u : batch.updates) {
+            if (u.type == Update::Type::Snapshot) u.levels_begin += base;
+            streamed.push(u);
+        }
+        streamed.levels.insert(streamed.levels.end(), batch.levels.begin(), batch.levels.end());
+    }
+    CHECK(streamed == reference);
+
+    UpdateLog threaded;
+    CHECK(AsyncCsvReader::parse_file<ThreadReadAhead>(path.c_str(), threaded));
+    CHECK(threaded == reference);
+
+    if (UringReadAhead::available()) {
+        UpdateLog uring;
+        CHECK(AsyncCsvReader::parse_file<UringReadAhead>(path.c_str(), uring));
+        CHECK(uring == reference);
+    }
+
+    unlink(path.c_str());
+}
+
+int main() {
+    test_stray_quote_stays_on_its_line();
+    test_unbalanced_last_line();
+    test_extra_fields_rejected();
+    test_quote_state_resets_across_blocks();
+    test_off_tick_prices_rejected();
+    test_readers_agree_on_malformed_input();
+    return finish("parser_test");
+}
@@ -0,0 +1,109 @@
+/// PriceLadder tests: the window stays capped when a far-away price
+/// arrives, far levels still count for best/size, and a random stream of
+/// set/erase gives the same book as the std::map store.
+
+#include <cstdint>
+#include <random>
+#include "price_ladder.h"
+#include "check.h"
+
+static bool same_best(const std::optional<Level>& a, const std::optional<Level>& b) {
+    if (!a || !b) return !a && !b;
+    return a->price == b->price && a->qty == b->qty;
+}
+
+static void test_far_price_does_not_grow_window() {
+    PriceLadder<Side::Ask> asks;
+    asks.set(Price(10'000'000), Qty(1));
+    asks.set(Price(10'000'050), Qty(2));
+
+    // Far above the touch: kept out of the window, which stays small.
+    asks.set(Price(UINT64_MAX / 2), Qty(3));
+    CHECK(asks.window_ticks() <= PriceLadder<Side::Ask>::DEFAULT_MAX_TICKS);
+    CHECK(asks.far_levels() == 1);
+    CHECK(asks.size() == 3);
+    CHECK(asks.best()->price == Price(10'000'000));
+
+    // Far below the touch: it becomes the best ask.
+    asks.set(Price(5), Qty(4));
+    CHECK(asks.window_ticks() <= PriceLadder<Side::Ask>::DEFAULT_MAX_TICKS);
+    CHECK(asks.size() == 4);
+    CHECK(asks.best()->price == Price(5));
+    CHECK(asks.best()->qty == Qty(4));
+
+    asks.erase(Price(5));
+    CHECK(asks.best()->price == Price(10'000'000));
+    asks.erase(Price(UINT64_MAX / 2));
+    CHECK(asks.far_levels() == 0);
+    CHECK(asks.size() == 2);
+}
+
+static void test_far_bid_is_best_when_window_empties() {
+    PriceLadder<Side::Bid> bids(64, 256);
+    bids.set(Price(1000), Qty(1));
+    bids.set(Price(50'000), Qty(2));
+    CHECK(bids.window_ticks() <= 256);
+    CHECK(bids.far_levels() == 1);
+    CHECK(bids.best()->price == Price(50'000));
+
+    bids.erase(Price(50'000));
+    CHECK(bids.best()->price == Price(1000));
+    bids.erase(Price(1000));
+    CHECK(!bids.best());
+    CHECK(bids.size() == 0);
+}
+
+static void test_far_level_moves_into_window() {
+    PriceLadder<Side::Bid> bids(64, 256);
+    bids.set(Price(1000), Qty(1));
+    bids.set(Price(10'000), Qty(2));
+    CHECK(bids.far_levels() == 1);
+
+    // Once the old levels are gone, a nearby price recentres the window
+    // over the far level, which is pulled in.
+    bids.erase(Price(1000));
+    bids.set(Price(9990), Qty(3));
+    CHECK(bids.far_levels() == 0);
+    CHECK(bids.size() == 2);
+    CHECK(bids.best()->price == Price(10'000));
+    bids.erase(Price(10'000));
+    CHECK(bids.best()->price == Price(9990));
+}
+
+/// Random set/erase around a drifting mid with occasional far outliers,
+/// checked against MapLevels after every step.
+template <Side S>
+static void test_matches_map_store() {
+    PriceLadder<S> ladder(64, 1024);
+    MapLevels<S> map;
+    std::mt19937_64 rng(42);
+    uint64_t mid = 1'000'000;
+
+    for (int step = 0; step < 200'000; ++step) {
+        if (rng() % 1000 == 0) mid += rng() % 4000 - 2000;
+        uint64_t raw = mid + rng() % 400 - 200;
+        if (rng() % 500 == 0) raw = (rng() % 2) ? mid + 100'000 + rng() % 1000 : mid / 2 + rng() % 1000;
+
+        if (rng() % 3 == 0) {
+            ladder.erase(Price(raw));
+            map.erase(Price(raw));
+        } else {
+            const Qty qty(1 + rng() % 100);
+            ladder.set(Price(raw), qty);
+            map.set(Price(raw), qty);
+        }
+        CHECK(ladder.size() == map.size());
+        CHECK(same_best(ladder.best(), map.best()));
+        CHECK(ladder.window_ticks() <= 1024);
+        if (check_failures) return;
+    }
+}
+
+int main() {
+    test_far_price_does_not_grow_window();
+    test_far_bid_is_best_when_window_empties();
+    test_far_level_moves_into_window();
+    test_matches_map_store<Side::Bid>();
+    test_matches_map_store<Side::Ask>();
+    return finish("price_ladder_test");
+}
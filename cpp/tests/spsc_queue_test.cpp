@@ -0,0 +1,217 @@
+/// SPSCQueue and SPSCRing tests on rings small enough that the indices
+/// wrap many times: bulk push/pop fill and drain partially around the wrap in FIFO
+/// order, elements are destroyed exactly once (including those left at
+/// destruction), a side whose cached view of the other index says full or
+/// empty reloads it, emplace() builds in the slot and front()/pop_commit()
+/// read and release in place, and a producer and consumer thread (moving
+/// random-sized batches, or emplacing and reading in place) lose or
+/// reorder nothing.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+#include "spsc_queue.h"
+#include "spsc_ring.h"
+#include "check.h"
+
+/// Counts live instances, so a missed or doubled destructor shows up.
+struct Tracked {
+    static inline int live = 0;
+    uint64_t value = 0;
+
+    Tracked() { ++live; }
+    Tracked(uint64_t v) : value(v) { ++live; }
+    Tracked(const Tracked& o) : value(o.value) { ++live; }
+    Tracked& operator=(const Tracked&) = default;
+    ~Tracked() { --live; }
+};
+
+template <template <typename, size_t> class Queue>
+static void test_bulk_wraps_in_order() {
+    Queue<uint64_t, 8> q;
+    uint64_t next_in = 0, next_out = 0;
+    std::vector<uint64_t> in, out(8);
+
+    // Push 5, pop 3, over and over: head and tail cross the end of the
+    // ring at every offset.
+    for (int round = 0; round < 100; ++round) {
+        in.clear();
+        for (int i = 0; i < 5; ++i) in.push_back(next_in + i);
+        const size_t pushed = q.try_push_bulk(in);
+        CHECK(pushed <= 5);
+        next_in += pushed;
+
+        const size_t popped = q.try_pop_bulk(std::span<uint64_t>(out.data(), 3));
+        for (size_t i = 0; i < popped; ++i) CHECK(out[i] == next_out + i);
+        next_out += popped;
+        CHECK(next_in - next_out <= 8);
+    }
+
+    // A full ring takes nothing more; draining returns the rest in order.
+    // One bulk pop may return fewer than are queued (SPSCRing hands out
+    // what its cached head covers first), so drain until it returns 0.
+    while (q.try_push_bulk(std::span<const uint64_t>(&next_in, 1)) == 1) ++next_in;
+    CHECK(next_in - next_out == 8);
+    CHECK(!q.try_push(next_in));
+    while (size_t n = q.try_pop_bulk(out)) {
+        for (size_t i = 0; i < n; ++i) CHECK(out[i] == next_out + i);
+        next_out += n;
+    }
+    CHECK(next_out == next_in);
+    CHECK(!q.try_pop());
+}
+
+template <template <typename, size_t> class Queue>
+static void test_bulk_destroys_once() {
+    {
+        Queue<Tracked, 4> q;
+        std::vector<Tracked> batch = {Tracked(1), Tracked(2), Tracked(3)};
+        std::vector<Tracked> out(2);
+        const int outside = Tracked::live;
+        int queued = 0;
+        for (int round = 0; round < 10; ++round) {
+            queued += static_cast<int>(q.try_push_bulk(batch));
+            CHECK(Tracked::live == outside + queued);
+            queued -= static_cast<int>(q.try_pop_bulk(out));
+            CHECK(Tracked::live == outside + queued);
+        }
+        // Whatever is still queued is destroyed with the queue.
+        CHECK(queued > 0);
+    }
+    CHECK(Tracked::live == 0);
+}
+
+/// Full, then one pop: the producer must see the freed slot. Empty, then
+/// one push: the consumer must see the new element. With cached indices
+/// both only show up after a reload.
+template <template <typename, size_t> class Queue>
+static void test_cached_indices_refresh() {
+    Queue<uint64_t, 4> q;
+    for (uint64_t round = 0; round < 10; ++round) {
+        for (uint64_t i = 0; i < 4; ++i) CHECK(q.try_push(round * 4 + i));
+        CHECK(!q.try_push(99));
+        CHECK(q.try_pop() == round * 4);
+        CHECK(q.try_push(99));
+        CHECK(!q.try_push(99));
+        for (uint64_t i = 1; i < 4; ++i) CHECK(q.try_pop() == round * 4 + i);
+        CHECK(q.try_pop() == 99u);
+        CHECK(!q.try_pop());
+    }
+}
+
+template <template <typename, size_t> class Queue>
+static void test_threads_bulk() {
+    constexpr uint64_t COUNT = 50'000;
+    Queue<uint64_t, 1024> q;
+    std::atomic<bool> closed{false};
+    uint64_t received = 0;
+    bool ordered = true;
+
+    std::thread consumer([&]() {
+        uint64_t out[16];
+        while (size_t n = q.pop_bulk(out, closed)) {
+            for (size_t i = 0; i < n; ++i) ordered = ordered && out[i] == received + i;
+            received += n;
+        }
+    });
+
+    std::mt19937_64 rng(3);
+    std::vector<uint64_t> batch;
+    for (uint64_t next = 0; next < COUNT;) {
+        batch.clear();
+        const uint64_t n = std::min<uint64_t>(1 + rng() % 100, COUNT - next);
+        for (uint64_t i = 0; i < n; ++i) batch.push_back(next + i);
+        q.push_bulk(batch);
+        next += n;
+    }
+    closed.store(true, std::memory_order_release);
+    consumer.join();
+
+    CHECK(received == COUNT);
+    CHECK(ordered);
+}
+
+/// Emplace until full, read part of the queue in place and release it,
+/// around the wrap. Each element is constructed once (no copies) and
+/// destroyed once by pop_commit.
+template <template <typename, size_t> class Queue>
+static void test_in_place_wraps() {
+    {
+        Queue<Tracked, 4> q;
+        std::atomic<bool> closed{false};
+        uint64_t next_in = 0, next_out = 0;
+        for (int round = 0; round < 50; ++round) {
+            while (q.try_emplace(next_in)) ++next_in;
+            CHECK(next_in - next_out == 4);
+            CHECK(Tracked::live == 4);
+
+            const size_t n = q.wait_ready(closed);
+            CHECK(n >= 1 && n <= 4);
+            for (size_t i = 0; i < n; ++i) CHECK(q.front(i).value == next_out + i);
+            const size_t take = std::min<size_t>(n, 1 + round % 3);
+            q.pop_commit(take);
+            next_out += take;
+            CHECK(Tracked::live == static_cast<int>(next_in - next_out));
+            CHECK(q.front().value == next_out);
+        }
+
+        // Closed with elements left: they are still handed out.
+        closed.store(true);
+        while (size_t n = q.wait_ready(closed)) {
+            CHECK(q.front().value == next_out);
+            q.pop_commit(n);
+            next_out += n;
+        }
+        CHECK(next_out == next_in);
+        CHECK(q.ready() == 0);
+        CHECK(Tracked::live == 0);
+
+        // Left queued at destruction: destroyed with the queue.
+        q.emplace(uint64_t{1});
+        q.emplace(uint64_t{2});
+        CHECK(Tracked::live == 2);
+    }
+    CHECK(Tracked::live == 0);
+}
+
+template <template <typename, size_t> class Queue>
+static void test_threads_in_place() {
+    constexpr uint64_t COUNT = 50'000;
+    Queue<uint64_t, 1024> q;
+    std::atomic<bool> closed{false};
+    uint64_t received = 0;
+    bool ordered = true;
+
+    std::thread consumer([&]() {
+        while (size_t n = q.wait_ready(closed)) {
+            for (size_t i = 0; i < n; ++i) ordered = ordered && q.front(i) == received + i;
+            q.pop_commit(n);
+            received += n;
+        }
+    });
+    for (uint64_t i = 0; i < COUNT; ++i) q.emplace(i);
+    closed.store(true, std::memory_order_release);
+    consumer.join();
+
+    CHECK(received == COUNT);
+    CHECK(ordered);
+}
+
+int main() {
+    test_bulk_wraps_in_order<SPSCQueue>();
+    test_bulk_destroys_once<SPSCQueue>();
+    test_cached_indices_refresh<SPSCQueue>();
+    test_threads_bulk<SPSCQueue>();
+    test_in_place_wraps<SPSCQueue>();
+    test_threads_in_place<SPSCQueue>();
+    test_bulk_wraps_in_order<SPSCRing>();
+    test_bulk_destroys_once<SPSCRing>();
+    test_cached_indices_refresh<SPSCRing>();
+    test_threads_bulk<SPSCRing>();
+    test_in_place_wraps<SPSCRing>();
+    test_threads_in_place<SPSCRing>();
+    return finish("spsc_queue_test");
+}
@@ -0,0 +1,130 @@
+/// Delta/varint codec tests: zigzag at the int64 limits, varint lengths at
+/// every 7-bit boundary up to the ten-byte maximum, round trips of extreme
+/// prices, quantities and timestamp deltas with and without readable
+/// padding, and rejection of truncated or over-long input.
+
+#include <cstdint>
+#include <vector>
+#include "varint_codec.h"
+#include "check.h"
+
+static Update incremental(Timestamp ts, Side side, uint64_t price, uint64_t lots) {
+    Update u{};
+    u.type = Update::Type::Incremental;
+    u.timestamp = ts;
+    u.side = side;
+    u.level = Level{Price(price), Qty(lots)};
+    return u;
+}
+
+/// Decode `bytes` as `count` updates. With `padded`, eight readable zero
+/// bytes follow the stream (as in a capture) so the word-at-a-time path
+/// runs to the end; without, the last varints go through the byte loop.
+static bool decode(const std::vector<uint8_t>& bytes, uint64_t count, bool padded, UpdateLog& out) {
+    std::vector<uint8_t> buf(bytes);
+    buf.resize(bytes.size() + (padded ? 8 : 0), 0);
+    return DeltaVarintCodec::decode(buf.data(), buf.data() + bytes.size(), buf.data() + buf.size(),
+                                    count, out);
+}
+
+static void test_zigzag_limits() {
+    const int64_t values[] = {0, -1, 1, -2, 63, -64, 64, INT64_MAX, INT64_MIN, INT64_MIN + 1};
+    for (int64_t v : values) CHECK(DeltaVarintCodec::unzigzag(DeltaVarintCodec::zigzag(v)) == v);
+    CHECK(DeltaVarintCodec::zigzag(0) == 0);
+    CHECK(DeltaVarintCodec::zigzag(-1) == 1);
+    CHECK(DeltaVarintCodec::zigzag(1) == 2);
+    CHECK(DeltaVarintCodec::zigzag(INT64_MAX) == UINT64_MAX - 1);
+    CHECK(DeltaVarintCodec::zigzag(INT64_MIN) == UINT64_MAX);
+}
+
+/// One incremental at timestamp 0 and price 0 encodes as a one-byte head,
+/// a one-byte price delta and the quantity varint, so the stream length
+/// gives the quantity's varint length.
+static void test_varint_lengths() {
+    for (unsigned bits = 0; bits <= 64; ++bits) {
+        const uint64_t below = bits == 0 ? 0 : (bits == 64 ? UINT64_MAX : (1ULL << bits) - 1);
+        const size_t want = bits <= 7 ? 1 : (bits + 6) / 7;
+
+        UpdateLog feed;
+        feed.push(incremental(0, Side::Bid, 0, below));
+        std::vector<uint8_t> bytes;
+        DeltaVarintCodec::encode(feed, bytes);
+        CHECK(bytes.size() == 2 + want);
+
+        for (bool padded : {false, true}) {
+            UpdateLog out;
+            CHECK(decode(bytes, 1, padded, out));
+            CHECK(out == feed);
+        }
+        if (check_failures) return;
+    }
+}
+
+static void test_extreme_round_trip() {
+    UpdateLog feed;
+    // Prices jump across the whole range (deltas wrap), quantities sit on
+    // varint boundaries, timestamps move by the largest deltas allowed
+    // (under 2^61) in both directions.
+    const uint64_t max_step = (1ULL << 61) - 1;
+    feed.push(incremental(0, Side::Bid, UINT64_MAX, 127));
+    feed.push(incremental(max_step, Side::Ask, 0, 128));
+    feed.push(incremental(0, Side::Bid, 0, (1ULL << 56) - 1));
+    feed.push(incremental(max_step, Side::Ask, UINT64_MAX, 1ULL << 56));
+    feed.push(incremental(max_step, Side::Bid, 1ULL << 63, UINT64_MAX));
+    feed.push(incremental(max_step, Side::Ask, 1, 0));
+
+    Update snap{};
+    snap.type = Update::Type::Snapshot;
+    snap.timestamp = max_step + 1;
+    snap.levels_begin = 0;
+    snap.bid_count = 3;
+    snap.ask_count = 2;
+    feed.levels = {Level{Price(UINT64_MAX), Qty(1)}, Level{Price(0), Qty(UINT64_MAX)},
+                   Level{Price(1ULL << 63), Qty(128)},
+                   Level{Price(1), Qty(0)}, Level{Price(UINT64_MAX - 1), Qty(1ULL << 62)}};
+    feed.push(snap);
+    feed.push(incremental(max_step + 1, Side::Bid, 5, 5));
+
+    std::vector<uint8_t> bytes;
+    DeltaVarintCodec::encode(feed, bytes);
+    for (bool padded : {false, true}) {
+        UpdateLog out;
+        CHECK(decode(bytes, feed.size(), padded, out));
+        CHECK(out == feed);
+    }
+}
+
+static void test_rejects_bad_input() {
+    UpdateLog feed;
+    feed.push(incremental(1, Side::Bid, 100, UINT64_MAX));
+    std::vector<uint8_t> bytes;
+    DeltaVarintCodec::encode(feed, bytes);
+
+    for (bool padded : {false, true}) {
+        // Cut anywhere inside the stream: the last varint never completes.
+        for (size_t cut = 0; cut < bytes.size(); ++cut) {
+            UpdateLog out;
+            CHECK(!decode(std::vector<uint8_t>(bytes.begin(), bytes.begin() + cut), 1, padded, out));
+        }
+        // More updates asked for than the stream holds.
+        UpdateLog out;
+        CHECK(!decode(bytes, 2, padded, out));
+    }
+
+    // Eleven continuation bytes: longer than any 64-bit varint.
+    const std::vector<uint8_t> endless(11, 0x80);
+    UpdateLog out;
+    CHECK(!decode(endless, 1, false, out));
+
+    // A snapshot whose level counts exceed what the remaining bytes hold.
+    const std::vector<uint8_t> huge = {0x00, 0xFF, 0xFF, 0xFF, 0x0F, 0x01};
+    CHECK(!decode(huge, 1, true, out));
+}
+
+int main() {
+    test_zigzag_limits();
+    test_varint_lengths();
+    test_extreme_round_trip();
+    test_rejects_bad_input();
+    return finish("varint_codec_test");
+}